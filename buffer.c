@@ -577,6 +577,9 @@ buf_freeall(buf, del_buf, wipe_buf)
     u_clearall(buf);		    /* reset all undo information */
 #ifdef FEAT_SYN_HL
     syntax_clear(buf);		    /* reset syntax info */
+#endif
+#ifdef FEAT_SEARCH_EXTRA
+    search_idx_free(buf);	    /* reset search match index */
 #endif
     buf->b_flags &= ~BF_READERR;    /* a read error is no longer relevant */
 }
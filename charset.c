@@ -73,6 +73,8 @@ buf_init_chartab(buf, global)
 
     if (global)
     {
+	++chartab_tick;
+
 	/*
 	 * Set the default size for printable characters:
 	 * From <Space> to '~' is 1 (printable), others are 2 (not printable).
@@ -915,6 +917,42 @@ vim_iswordc_buf(p, buf)
 # endif
     return (GET_CHARTAB(buf, *p) != 0);
 }
+
+/*
+ * Return the length in bytes of the word at "p", using the word characters
+ * of buffer "buf".  The first character is assumed to be a word character.
+ * Like calling vim_iswordc_buf() for each character, but for single-byte
+ * characters the table is used directly.
+ */
+    int
+vim_wordlen_buf(p, buf)
+    char_u	*p;
+    buf_T	*buf;
+{
+    char_u	*s = p;
+
+    for (;;)
+    {
+# ifdef FEAT_MBYTE
+	/* A composing character may follow an ASCII character. */
+	if (has_mbyte && (*s >= 0x80 || (enc_utf8 && s[1] >= 0x80)))
+	    s += (*mb_ptr2len)(s);
+	else
+# endif
+	    ++s;
+# ifdef FEAT_MBYTE
+	if (has_mbyte && MB_BYTE2LEN(*s) > 1)
+	{
+	    if (mb_get_class(s) < 2)
+		break;
+	}
+	else
+# endif
+	    if (GET_CHARTAB(buf, *s) == 0)
+		break;
+    }
+    return (int)(s - p);
+}
 #endif
 
 /*
@@ -1198,6 +1236,288 @@ in_win_border(wp, vcol)
 }
 #endif /* FEAT_MBYTE */
 
+/*
+ * Checkpoints of the virtual column in long lines, so that getvcol(),
+ * coladvance2() and win_line() don't have to count the cells of all
+ * characters from the start of the line.  There is a checkpoint at the first
+ * character at or after every VC_STEP bytes.  The checkpoints of a line are
+ * kept in vcol_cache["lnum" % VC_LINES], thus all lines in a window can have
+ * them.  They depend on the text and on the options that change the size of
+ * characters, see vcol_cache_get().  Changing text after a checkpoint drops
+ * it, see vcol_cache_changed().
+ */
+#define VC_STEP		512
+#define VC_LINES	64
+
+typedef struct
+{
+    colnr_T	vp_col;		/* byte index of the character */
+    colnr_T	vp_vcol;	/* its virtual column */
+} vcpoint_T;
+
+typedef struct
+{
+    int		vc_fnum;	/* b_fnum of the buffer, 0 when not used */
+    linenr_T	vc_lnum;	/* line number */
+    int		vc_changedtick;	/* b_changedtick of the buffer */
+    long	vc_ts;		/* 'tabstop' */
+    int		vc_list;	/* 'list' */
+    int		vc_lbr;		/* 'linebreak' */
+    int		vc_wrap;	/* 'wrap' */
+    int		vc_width;	/* W_WIDTH() - win_col_off() */
+    int		vc_off2;	/* win_col_off2() */
+    int		vc_done;	/* TRUE when checkpoints go up to the NUL */
+    garray_T	vc_ga;		/* checkpoints, vcpoint_T items */
+} vcline_T;
+
+static vcline_T vcol_cache[VC_LINES];
+
+static vcline_T *vcol_cache_get __ARGS((win_T *wp, linenr_T lnum));
+
+/*
+ * Get the checkpoints for line "lnum" as it is displayed in window "wp".
+ * When the entry was for another line or text, it is emptied.
+ */
+    static vcline_T *
+vcol_cache_get(wp, lnum)
+    win_T	*wp;
+    linenr_T	lnum;
+{
+    vcline_T	*vc = &vcol_cache[lnum % VC_LINES];
+    buf_T	*buf = wp->w_buffer;
+    int		width = W_WIDTH(wp) - win_col_off(wp);
+    int		off2 = win_col_off2(wp);
+
+    if (vc->vc_fnum == buf->b_fnum
+	    && vc->vc_lnum == lnum
+	    && vc->vc_changedtick == buf->b_changedtick
+	    && vc->vc_ts == buf->b_p_ts
+	    && vc->vc_list == wp->w_p_list
+#ifdef FEAT_LINEBREAK
+	    && vc->vc_lbr == wp->w_p_lbr
+#endif
+	    && vc->vc_wrap == wp->w_p_wrap
+	    && vc->vc_width == width
+	    && vc->vc_off2 == off2)
+	return vc;
+
+    vc->vc_fnum = buf->b_fnum;
+    vc->vc_lnum = lnum;
+    vc->vc_changedtick = buf->b_changedtick;
+    vc->vc_ts = buf->b_p_ts;
+    vc->vc_list = wp->w_p_list;
+#ifdef FEAT_LINEBREAK
+    vc->vc_lbr = wp->w_p_lbr;
+#endif
+    vc->vc_wrap = wp->w_p_wrap;
+    vc->vc_width = width;
+    vc->vc_off2 = off2;
+    vc->vc_done = FALSE;
+    if (vc->vc_ga.ga_itemsize == 0)
+	ga_init2(&vc->vc_ga, (int)sizeof(vcpoint_T), 20);
+    vc->vc_ga.ga_len = 0;
+    return vc;
+}
+
+/*
+ * Find the last checkpoint in "line", line "lnum" of window "wp", that is at
+ * or before byte index "col" and at or before virtual column "vcol".  Adds
+ * checkpoints when needed.
+ * Returns the byte index of the checkpoint and sets "*vcolp" to its virtual
+ * column.  Returns zero when the first character is just as near.
+ */
+    colnr_T
+vcol_checkpoint(wp, lnum, line, col, vcol, vcolp)
+    win_T	*wp;
+    linenr_T	lnum;
+    char_u	*line;
+    colnr_T	col;
+    colnr_T	vcol;
+    colnr_T	*vcolp;
+{
+    vcline_T	*vc;
+    vcpoint_T	*vp;
+    char_u	*ptr;
+    colnr_T	v;
+    colnr_T	next;
+    int		lo, hi, mid;
+
+    *vcolp = 0;
+    /* Short distances are quicker to count directly. */
+    if (col < VC_STEP || vcol < VC_STEP)
+	return 0;
+
+    vc = vcol_cache_get(wp, lnum);
+
+    /* Never use a checkpoint beyond the end of the line, in case the text
+     * changed without b_changedtick changing. */
+    vp = (vcpoint_T *)vc->vc_ga.ga_data;
+    if (vc->vc_ga.ga_len > 0
+		&& vp[vc->vc_ga.ga_len - 1].vp_col > (colnr_T)STRLEN(line))
+    {
+	vc->vc_ga.ga_len = 0;
+	vc->vc_done = FALSE;
+    }
+
+    /* Add checkpoints until one is beyond "col" or "vcol". */
+    while (!vc->vc_done
+	    && (vc->vc_ga.ga_len == 0
+		|| (vp[vc->vc_ga.ga_len - 1].vp_col <= col
+		    && vp[vc->vc_ga.ga_len - 1].vp_vcol <= vcol)))
+    {
+	if (vc->vc_ga.ga_len == 0)
+	{
+	    ptr = line;
+	    v = 0;
+	}
+	else
+	{
+	    ptr = line + vp[vc->vc_ga.ga_len - 1].vp_col;
+	    v = vp[vc->vc_ga.ga_len - 1].vp_vcol;
+	}
+	next = (colnr_T)((ptr - line) / VC_STEP + 1) * VC_STEP;
+	while (*ptr != NUL && ptr - line < next)
+	{
+	    v += win_lbr_chartabsize(wp, ptr, v, NULL);
+	    mb_ptr_adv(ptr);
+	}
+	if (*ptr == NUL)
+	    vc->vc_done = TRUE;
+	else
+	{
+	    if (ga_grow(&vc->vc_ga, 1) == FAIL)
+		break;
+	    vp = (vcpoint_T *)vc->vc_ga.ga_data;
+	    vp[vc->vc_ga.ga_len].vp_col = (colnr_T)(ptr - line);
+	    vp[vc->vc_ga.ga_len].vp_vcol = v;
+	    ++vc->vc_ga.ga_len;
+	}
+    }
+
+    /* Binary search for the last checkpoint not beyond "col" and "vcol". */
+    lo = 0;
+    hi = vc->vc_ga.ga_len;
+    while (lo < hi)
+    {
+	mid = (lo + hi) / 2;
+	if (vp[mid].vp_col <= col && vp[mid].vp_vcol <= vcol)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    if (lo == 0)
+	return 0;
+    *vcolp = vp[lo - 1].vp_vcol;
+    return vp[lo - 1].vp_col;
+}
+
+/*
+ * Drop checkpoints of the current buffer after a change: lines "lnum" to
+ * "lnume" (not including) changed, starting at byte "col", and "xtra" lines
+ * were inserted or deleted below them.  When only line "lnum" changed its
+ * checkpoints up to "col" remain valid.  "tick" is b_changedtick from before
+ * the change.
+ */
+    void
+vcol_cache_changed(lnum, col, lnume, xtra, tick)
+    linenr_T	lnum;
+    colnr_T	col;
+    linenr_T	lnume;
+    long	xtra;
+    int		tick;
+{
+    vcline_T	*vc;
+    vcpoint_T	*vp;
+    int		i;
+    colnr_T	keep;
+#ifdef FEAT_LINEBREAK
+    char_u	*line;
+#endif
+
+    for (i = 0; i < VC_LINES; ++i)
+    {
+	vc = &vcol_cache[i];
+	if (vc->vc_fnum != curbuf->b_fnum || vc->vc_changedtick != tick)
+	    continue;
+	if (vc->vc_lnum == lnum && lnume == lnum + 1 && xtra == 0)
+	{
+	    /* A checkpoint at "col" is still valid, only the text after it
+	     * changed. */
+	    keep = col;
+#ifdef FEAT_LINEBREAK
+	    /* With 'linebreak' the size of a blank depends on the text after
+	     * it, up to the start of the next word.  Only keep checkpoints up
+	     * to the blank before the word before the changed word. */
+	    if (vc->vc_lbr)
+	    {
+		line = ml_get(lnum);
+		keep = col - 1;
+		while (keep >= 0 && !vim_isbreak(line[keep]))
+		    --keep;
+		while (keep >= 0 && vim_isbreak(line[keep]))
+		    --keep;
+		while (keep >= 0 && !vim_isbreak(line[keep]))
+		    --keep;
+	    }
+#endif
+	    vp = (vcpoint_T *)vc->vc_ga.ga_data;
+	    while (vc->vc_ga.ga_len > 0
+				&& vp[vc->vc_ga.ga_len - 1].vp_col > keep)
+		--vc->vc_ga.ga_len;
+	    vc->vc_done = FALSE;
+	}
+	else if (vc->vc_lnum >= lnum && (vc->vc_lnum < lnume || xtra != 0))
+	{
+	    /* The line changed or moved. */
+	    vc->vc_fnum = 0;
+	    continue;
+	}
+	vc->vc_changedtick = curbuf->b_changedtick;
+    }
+}
+
+/*
+ * Drop the checkpoints of buffer "buf".  Used when its text was read again,
+ * b_changedtick doesn't change then.
+ */
+    void
+vcol_cache_buf_clear(buf)
+    buf_T	*buf;
+{
+    int		i;
+
+    for (i = 0; i < VC_LINES; ++i)
+	if (vcol_cache[i].vc_fnum == buf->b_fnum)
+	    vcol_cache[i].vc_fnum = 0;
+}
+
+/*
+ * Drop all checkpoints.  Used when an option changed that may change the
+ * size of characters.
+ */
+    void
+vcol_cache_clear()
+{
+    int		i;
+
+    for (i = 0; i < VC_LINES; ++i)
+	vcol_cache[i].vc_fnum = 0;
+}
+
+#if defined(EXITFREE) || defined(PROTO)
+    void
+vcol_cache_free()
+{
+    int		i;
+
+    for (i = 0; i < VC_LINES; ++i)
+    {
+	vcol_cache[i].vc_fnum = 0;
+	ga_clear(&vcol_cache[i].vc_ga);
+    }
+}
+#endif
+
 /*
  * Get virtual column number of pos.
  *  start: on the first position of this character (TAB, ctrl)
@@ -1226,6 +1546,9 @@ getvcol(wp, pos, start, cursor, end)
     ptr = ml_get_buf(wp->w_buffer, pos->lnum, FALSE);
     posptr = ptr + pos->col;
 
+    /* In a long line start counting at a checkpoint. */
+    ptr += vcol_checkpoint(wp, pos->lnum, ptr, pos->col, MAXCOL, &vcol);
+
     /*
      * This function is used very often, do some speed optimizations.
      * When 'list', 'linebreak' and 'showbreak' are not set use a simple loop.
@@ -1270,7 +1593,8 @@ getvcol(wp, pos, start, cursor, end)
 		    /* If a double-cell char doesn't fit at the end of a line
 		     * it wraps to the next line, it's like this char is three
 		     * cells wide. */
-		    if (incr == 2 && wp->w_p_wrap && in_win_border(wp, vcol))
+		    if (incr == 2 && wp->w_p_wrap && MB_BYTE2LEN(c) > 1
+						  && in_win_border(wp, vcol))
 		    {
 			++incr;
 			head = 1;
@@ -644,6 +644,7 @@ static void f_submatch __ARGS((typval_T *argvars, typval_T *rettv));
 static void f_substitute __ARGS((typval_T *argvars, typval_T *rettv));
 static void f_synID __ARGS((typval_T *argvars, typval_T *rettv));
 static void f_synIDattr __ARGS((typval_T *argvars, typval_T *rettv));
+static void f_synIDruns __ARGS((typval_T *argvars, typval_T *rettv));
 static void f_synIDtrans __ARGS((typval_T *argvars, typval_T *rettv));
 static void f_system __ARGS((typval_T *argvars, typval_T *rettv));
 static void f_tabpagebuflist __ARGS((typval_T *argvars, typval_T *rettv));
@@ -7216,6 +7217,7 @@ static struct fst
     {"substitute",	4, 4, f_substitute},
     {"synID",		3, 3, f_synID},
     {"synIDattr",	2, 3, f_synIDattr},
+    {"synIDruns",	2, 2, f_synIDruns},
     {"synIDtrans",	1, 1, f_synIDtrans},
     {"system",		1, 2, f_system},
     {"tabpagebuflist",	0, 1, f_tabpagebuflist},
@@ -10751,7 +10753,7 @@ f_has(argvars, rettv)
 #ifdef FEAT_SEARCHPATH
 	"file_in_path",
 #endif
-#if defined(UNIX) && !defined(USE_SYSTEM)
+#if (defined(UNIX) || defined(PLAN9)) && !defined(USE_SYSTEM)
 	"filterpipe",
 #endif
 #ifdef FEAT_FIND_ID
@@ -13895,7 +13897,7 @@ search_cmn(argvars, match_pos, flagsp)
 
     pos = save_cursor = curwin->w_cursor;
     subpatnum = searchit(curwin, curbuf, &pos, dir, pat, 1L,
-				     options, RE_SEARCH, (linenr_T)lnum_stop);
+			       options, RE_SEARCH, (linenr_T)lnum_stop, NULL);
     if (subpatnum != FAIL)
     {
 	if (flags & SP_SUBPAT)
@@ -14127,7 +14129,7 @@ do_searchpair(spat, mpat, epat, dir, skip, flags, match_pos, lnum_stop)
     for (;;)
     {
 	n = searchit(curwin, curbuf, &pos, dir, pat, 1L,
-					       options, RE_SEARCH, lnum_stop);
+					 options, RE_SEARCH, lnum_stop, NULL);
 	if (n == FAIL || (firstpos.lnum != 0 && equalpos(pos, firstpos)))
 	    /* didn't find it or found the first match again: FAIL */
 	    break;
@@ -15560,6 +15562,73 @@ f_synIDattr(argvars, rettv)
     rettv->vval.v_string = p;
 }
 
+/*
+ * "synIDruns(lnum, trans)" function
+ */
+/*ARGSUSED*/
+    static void
+f_synIDruns(argvars, rettv)
+    typval_T	*argvars;
+    typval_T	*rettv;
+{
+#ifdef FEAT_SYN_HL
+    long	lnum;
+    int		trans;
+    int		transerr = FALSE;
+    garray_T	ga;
+    int		*ids;
+    int		col;
+    int		len;
+    list_T	*l2;
+    listitem_T	*li;
+#endif
+
+    if (rettv_list_alloc(rettv) == FAIL)
+	return;
+
+#ifdef FEAT_SYN_HL
+    lnum = get_tv_lnum(argvars);		/* -1 on type error */
+    trans = get_tv_number_chk(&argvars[1], &transerr);
+    if (transerr || lnum < 1 || lnum > curbuf->b_ml.ml_line_count)
+	return;
+
+    /* Get the IDs of the whole line in one go, then collect runs of the
+     * same ID: [col, len, id]. */
+    ga_init2(&ga, (int)sizeof(int), 100);
+    if (syn_get_line_ids(curwin, (linenr_T)lnum, trans, &ga) == OK)
+    {
+	ids = (int *)ga.ga_data;
+	for (col = 0; col < ga.ga_len; col += len)
+	{
+	    for (len = 1; col + len < ga.ga_len; ++len)
+		if (ids[col + len] != ids[col])
+		    break;
+
+	    l2 = list_alloc();
+	    if (l2 == NULL)
+		break;
+	    li = listitem_alloc();
+	    if (li == NULL)
+	    {
+		list_free(l2, TRUE);
+		break;
+	    }
+	    li->li_tv.v_type = VAR_LIST;
+	    li->li_tv.v_lock = 0;
+	    li->li_tv.vval.v_list = l2;
+	    ++l2->lv_refcount;
+	    list_append(rettv->vval.v_list, li);
+
+	    if (list_append_number(l2, (varnumber_T)(col + 1)) == FAIL
+		    || list_append_number(l2, (varnumber_T)len) == FAIL
+		    || list_append_number(l2, (varnumber_T)ids[col]) == FAIL)
+		break;
+	}
+    }
+    ga_clear(&ga);
+#endif
+}
+
 /*
  * "synIDtrans(id)" function
  */
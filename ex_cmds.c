@@ -19,6 +19,7 @@
 
 #ifdef FEAT_EX_EXTRA
 static int linelen __ARGS((int *has_tab));
+static int linelen_indent __ARGS((int indent));
 #endif
 static void do_filter __ARGS((linenr_T line1, linenr_T line2, exarg_T *eap, char_u *cmd, int do_in, int do_out));
 #ifdef FEAT_VIMINFO
@@ -33,12 +34,32 @@ static int check_readonly __ARGS((int *forceit, buf_T *buf));
 #ifdef FEAT_AUTOCMD
 static void delbuf_msg __ARGS((char_u *name));
 #endif
+static int sub_stage_add __ARGS((garray_T *gap, linenr_T lnum, char_u *line));
+static int sub_stage_flush __ARGS((garray_T *gap));
+static int global_is_delete __ARGS((char_u *cmd));
+static void global_delete_bulk __ARGS((void));
 static int
 #ifdef __BORLANDC__
     _RTLENTRYF
 #endif
 	help_compare __ARGS((const void *s1, const void *s2));
 
+/*
+ * Changes made by ":substitute" and ":retab" that are not in the buffer yet.
+ * Saving each changed line for undo by itself is slow for something like
+ * ":%s/a/b/" in a big buffer.  When the changed lines can't be seen while
+ * matching in the following lines, they are staged here and saved for undo
+ * in blocks.
+ */
+typedef struct
+{
+    linenr_T	ss_lnum;	/* line number in the buffer */
+    char_u	*ss_line;	/* allocated new text for the line */
+} substage_T;
+
+#define SUB_STAGE_MAX	1000	/* max nr of lines saved for undo at once */
+#define SUB_STAGE_GAP	8	/* max nr of unchanged lines in a block */
+
 /*
  * ":ascii" and "ga".
  */
@@ -147,6 +168,7 @@ ex_align(eap)
     int		new_indent;
     int		has_tab;
     int		width;
+    int		fast;
 
 #ifdef FEAT_RIGHTLEFT
     if (curwin->w_p_rl)
@@ -184,6 +206,14 @@ ex_align(eap)
     if (u_save((linenr_T)(eap->line1 - 1), (linenr_T)(eap->line2 + 1)) == FAIL)
 	return;
 
+    /* When every character takes its normal width the length of the line
+     * for an indent can be computed without changing the line. */
+    fast = !curwin->w_p_list
+#ifdef FEAT_LINEBREAK
+	&& !curwin->w_p_lbr && *p_sbr == NUL
+#endif
+	;
+
     for (curwin->w_cursor.lnum = eap->line1;
 		 curwin->w_cursor.lnum <= eap->line2; ++curwin->w_cursor.lnum)
     {
@@ -208,7 +238,16 @@ ex_align(eap)
 		 * Make sure that embedded TABs don't make the text go too far
 		 * to the right.
 		 */
-		if (has_tab)
+		if (has_tab && fast)
+		{
+		    while (new_indent > 0
+				    && linelen_indent(new_indent) > width)
+			--new_indent;
+		    if (new_indent > 0)
+			while (linelen_indent(new_indent + 1) <= width)
+			    ++new_indent;
+		}
+		else if (has_tab)
 		    while (new_indent > 0)
 		    {
 			(void)set_indent(new_indent, 0);
@@ -268,10 +307,34 @@ linelen(has_tab)
     return len;
 }
 
-/* Buffer for two lines used during sorting.  They are allocated to
- * contain the longest line being sorted. */
+/*
+ * Return what linelen() would return for the current line after changing its
+ * indent to "indent", without changing it.  Only valid when all characters
+ * have their normal width: 'list', 'linebreak' and 'showbreak' are not used.
+ */
+    static int
+linelen_indent(indent)
+    int	    indent;
+{
+    char_u  *first;
+    char_u  *last;
+    int	    len = indent;
+
+    first = skipwhite(ml_get_curline());
+    for (last = first + STRLEN(first);
+				last > first && vim_iswhite(last[-1]); --last)
+	;
+    while (first < last)
+    {
+	len += chartabsize(first, (colnr_T)len);
+	mb_ptr_adv(first);
+    }
+    return len;
+}
+
+/* Buffer for the previous line when removing duplicates.  It is allocated
+ * to contain the longest line being sorted. */
 static char_u	*sortbuf1;
-static char_u	*sortbuf2;
 
 static int	sort_ic;		/* ignore case */
 static int	sort_nr;		/* sort on number */
@@ -285,59 +348,148 @@ typedef struct
     linenr_T	lnum;			/* line number */
     long	start_col_nr;		/* starting column number or number */
     long	end_col_nr;		/* ending column number */
+    char_u	*key;			/* text to sort on, in the key arena */
 } sorti_T;
 
-static int
-#ifdef __BORLANDC__
-_RTLENTRYF
-#endif
-sort_compare __ARGS((const void *s1, const void *s2));
+#define SORT_RUN 8		/* length of runs sorted by insertion */
+
+static int sort_compare __ARGS((sorti_T *l1, sorti_T *l2));
+static void sort_merge __ARGS((sorti_T *nrs, sorti_T *tmp, size_t count));
+static void sort_radix __ARGS((sorti_T *nrs, sorti_T *tmp, size_t count));
 
+/*
+ * Compare the text keys of two lines.
+ */
     static int
-#ifdef __BORLANDC__
-_RTLENTRYF
-#endif
-sort_compare(s1, s2)
-    const void	*s1;
-    const void	*s2;
+sort_compare(l1, l2)
+    sorti_T	*l1;
+    sorti_T	*l2;
 {
-    sorti_T	l1 = *(sorti_T *)s1;
-    sorti_T	l2 = *(sorti_T *)s2;
-    int		result = 0;
+    return sort_ic ? STRICMP(l1->key, l2->key) : STRCMP(l1->key, l2->key);
+}
 
-    /* If the user interrupts, there's no way to stop qsort() immediately, but
-     * if we return 0 every time, qsort will assume it's done sorting and
-     * exit. */
-    if (sort_abort)
-	return 0;
-    fast_breakcheck();
-    if (got_int)
-	sort_abort = TRUE;
+/*
+ * Sort "nrs[count]" on the text keys with a bottom-up merge sort, using
+ * "tmp[count]" as scratch space.  The sort is stable: lines with the same
+ * key keep their order.  Sets "sort_abort" when interrupted.
+ */
+    static void
+sort_merge(nrs, tmp, count)
+    sorti_T	*nrs;
+    sorti_T	*tmp;
+    size_t	count;
+{
+    sorti_T	*src = nrs;
+    sorti_T	*dst = tmp;
+    sorti_T	*t;
+    sorti_T	item;
+    size_t	width;
+    size_t	lo, mid, hi;
+    size_t	i, j, k;
+
+    /* Sort short runs with insertion sort first, it's faster on few items. */
+    for (lo = 0; lo < count; lo += SORT_RUN)
+    {
+	hi = lo + SORT_RUN < count ? lo + SORT_RUN : count;
+	for (i = lo + 1; i < hi; ++i)
+	{
+	    item = src[i];
+	    for (j = i; j > lo && sort_compare(&src[j - 1], &item) > 0; --j)
+		src[j] = src[j - 1];
+	    src[j] = item;
+	}
+    }
 
-    /* When sorting numbers "start_col_nr" is the number, not the column
-     * number. */
-    if (sort_nr)
-	result = l1.start_col_nr - l2.start_col_nr;
-    else
+    for (width = SORT_RUN; width < count; width *= 2)
     {
-	/* We need to copy one line into "sortbuf1", because there is no
-	 * guarantee that the first pointer becomes invalid when obtaining the
-	 * second one. */
-	STRNCPY(sortbuf1, ml_get(l1.lnum) + l1.start_col_nr,
-					 l1.end_col_nr - l1.start_col_nr + 1);
-	sortbuf1[l1.end_col_nr - l1.start_col_nr] = 0;
-	STRNCPY(sortbuf2, ml_get(l2.lnum) + l2.start_col_nr,
-					 l2.end_col_nr - l2.start_col_nr + 1);
-	sortbuf2[l2.end_col_nr - l2.start_col_nr] = 0;
+	for (lo = 0; lo < count; lo += 2 * width)
+	{
+	    mid = lo + width < count ? lo + width : count;
+	    hi = lo + 2 * width < count ? lo + 2 * width : count;
+	    i = lo;
+	    j = mid;
+	    k = lo;
+	    /* Take from the left run when equal, this keeps the sort stable. */
+	    while (i < mid && j < hi)
+		dst[k++] = sort_compare(&src[j], &src[i]) < 0
+							? src[j++] : src[i++];
+	    while (i < mid)
+		dst[k++] = src[i++];
+	    while (j < hi)
+		dst[k++] = src[j++];
+
+	    fast_breakcheck();
+	    if (got_int)
+	    {
+		sort_abort = TRUE;
+		return;
+	    }
+	}
+	t = src;
+	src = dst;
+	dst = t;
+    }
+
+    if (src != nrs)
+	mch_memmove(nrs, src, count * sizeof(sorti_T));
+}
+
+/*
+ * Sort "nrs[count]" on the number in "start_col_nr" with an LSD radix sort,
+ * eight bits at a time, using "tmp[count]" as scratch space.  Passes where
+ * all numbers have the same digit are skipped.  The sort is stable.
+ */
+    static void
+sort_radix(nrs, tmp, count)
+    sorti_T	*nrs;
+    sorti_T	*tmp;
+    size_t	count;
+{
+    sorti_T	*src = nrs;
+    sorti_T	*dst = tmp;
+    sorti_T	*t;
+    size_t	cnt[256];
+    size_t	pos, n;
+    size_t	i;
+    int		shift;
+    int		d;
+    long_u	signbit = (long_u)1 << (sizeof(long) * 8 - 1);
+
+    /* Flipping the sign bit makes the unsigned order the signed order. */
+#define SORT_DIGIT(item, shift) \
+	((int)((((long_u)(item).start_col_nr ^ signbit) >> (shift)) & 0xff))
+    for (shift = 0; shift < (int)sizeof(long) * 8; shift += 8)
+    {
+	vim_memset(cnt, 0, sizeof(cnt));
+	for (i = 0; i < count; ++i)
+	    ++cnt[SORT_DIGIT(src[i], shift)];
+	if (cnt[SORT_DIGIT(src[0], shift)] == count)
+	    continue;
+
+	pos = 0;
+	for (d = 0; d < 256; ++d)
+	{
+	    n = cnt[d];
+	    cnt[d] = pos;
+	    pos += n;
+	}
+	for (i = 0; i < count; ++i)
+	    dst[cnt[SORT_DIGIT(src[i], shift)]++] = src[i];
+	t = src;
+	src = dst;
+	dst = t;
 
-	result = sort_ic ? STRICMP(sortbuf1, sortbuf2)
-						 : STRCMP(sortbuf1, sortbuf2);
+	fast_breakcheck();
+	if (got_int)
+	{
+	    sort_abort = TRUE;
+	    return;
+	}
     }
+#undef SORT_DIGIT
 
-    /* If two lines have the same value, preserve the original line order. */
-    if (result == 0)
-	return (int)(l1.lnum - l2.lnum);
-    return result;
+    if (src != nrs)
+	mch_memmove(nrs, src, count * sizeof(sorti_T));
 }
 
 /*
@@ -351,7 +503,10 @@ ex_sort(eap)
     int		len;
     linenr_T	lnum;
     long	maxlen = 0;
+    long_u	keylen = 0;		/* total size of the text keys */
+    char_u	*keys = NULL;		/* arena with the text keys */
     sorti_T	*nrs;
+    sorti_T	*tmp = NULL;
     size_t	count = eap->line2 - eap->line1 + 1;
     size_t	i;
     char_u	*p;
@@ -368,7 +523,6 @@ ex_sort(eap)
     if (u_save((linenr_T)(eap->line1 - 1), (linenr_T)(eap->line2 + 1)) == FAIL)
 	return;
     sortbuf1 = NULL;
-    sortbuf2 = NULL;
     regmatch.regprog = NULL;
     nrs = (sorti_T *)lalloc((long_u)(count * sizeof(sorti_T)), TRUE);
     if (nrs == NULL)
@@ -483,6 +637,7 @@ ex_sort(eap)
 	    /* Store the column to sort at. */
 	    nrs[lnum - eap->line1].start_col_nr = start_col;
 	    nrs[lnum - eap->line1].end_col_nr = end_col;
+	    keylen += end_col - start_col + 1;
 	}
 
 	nrs[lnum - eap->line1].lnum = lnum;
@@ -497,12 +652,34 @@ ex_sort(eap)
     sortbuf1 = alloc((unsigned)maxlen + 1);
     if (sortbuf1 == NULL)
 	goto sortend;
-    sortbuf2 = alloc((unsigned)maxlen + 1);
-    if (sortbuf2 == NULL)
+    tmp = (sorti_T *)lalloc((long_u)(count * sizeof(sorti_T)), TRUE);
+    if (tmp == NULL)
 	goto sortend;
 
-    /* Sort the array of line numbers.  Note: can't be interrupted! */
-    qsort((void *)nrs, count, sizeof(sorti_T), sort_compare);
+    if (sort_nr)
+	sort_radix(nrs, tmp, count);
+    else
+    {
+	/*
+	 * Copy the text to sort on into one block of memory, so that comparing
+	 * doesn't need to get the lines from the buffer every time.  The lines
+	 * are obtained in order, which is cheap.
+	 */
+	keys = lalloc(keylen, TRUE);
+	if (keys == NULL)
+	    goto sortend;
+	p = keys;
+	for (i = 0; i < count; ++i)
+	{
+	    len = (int)(nrs[i].end_col_nr - nrs[i].start_col_nr);
+	    mch_memmove(p, ml_get(nrs[i].lnum) + nrs[i].start_col_nr,
+								 (size_t)len);
+	    p[len] = NUL;
+	    nrs[i].key = p;
+	    p += len + 1;
+	}
+	sort_merge(nrs, tmp, count);
+    }
 
     if (sort_abort)
 	goto sortend;
@@ -545,8 +722,9 @@ ex_sort(eap)
 
 sortend:
     vim_free(nrs);
+    vim_free(tmp);
+    vim_free(keys);
     vim_free(sortbuf1);
-    vim_free(sortbuf2);
     vim_free(regmatch.regprog);
     if (got_int)
 	EMSG(_(e_interr));
@@ -569,10 +747,11 @@ ex_retab(eap)
     long	start_col = 0;		/* For start of white-space string */
     long	start_vcol = 0;		/* For start of white-space string */
     int		temp;
-    long	old_len;
+    long	done_col;		/* text before this is in "ga" */
     char_u	*ptr;
-    char_u	*new_line = (char_u *)1;    /* init to non-NULL */
-    int		did_undo;		/* called u_save for current line */
+    garray_T	ga;			/* new text for the current line */
+    garray_T	staged;			/* changed lines, substage_T */
+    int		failed = FALSE;
     int		new_ts;
     int		save_list;
     linenr_T	first_line = 0;		/* first changed line */
@@ -589,12 +768,19 @@ ex_retab(eap)
     }
     if (new_ts == 0)
 	new_ts = curbuf->b_p_ts;
+
+    /* The new text of a line is built in "ga" in one pass over the line.
+     * Changed lines are staged and saved for undo in blocks, like
+     * ":substitute" does. */
+    ga_init2(&ga, 1, 200);
+    ga_init2(&staged, (int)sizeof(substage_T), 100);
     for (lnum = eap->line1; !got_int && lnum <= eap->line2; ++lnum)
     {
 	ptr = ml_get(lnum);
 	col = 0;
 	vcol = 0;
-	did_undo = FALSE;
+	done_col = -1;
+	ga.ga_len = 0;
 	for (;;)
 	{
 	    if (vim_iswhite(ptr[col]))
@@ -633,37 +819,23 @@ ex_retab(eap)
 		    if (curbuf->b_p_et || got_tab ||
 					(num_spaces + num_tabs < len))
 		    {
-			if (did_undo == FALSE)
-			{
-			    did_undo = TRUE;
-			    if (u_save((linenr_T)(lnum - 1),
-						(linenr_T)(lnum + 1)) == FAIL)
-			    {
-				new_line = NULL;	/* flag out-of-memory */
-				break;
-			    }
-			}
-
 			/* len is actual number of white characters used */
 			len = num_spaces + num_tabs;
-			old_len = (long)STRLEN(ptr);
-			new_line = lalloc(old_len - col + start_col + len + 1,
-									TRUE);
-			if (new_line == NULL)
+			if (done_col < 0)
+			    done_col = 0;
+			if (ga_grow(&ga, (int)(start_col - done_col + len))
+								      == FAIL)
+			{
+			    failed = TRUE;
 			    break;
-			if (start_col > 0)
-			    mch_memmove(new_line, ptr, (size_t)start_col);
-			mch_memmove(new_line + start_col + len,
-				      ptr + col, (size_t)(old_len - col + 1));
-			ptr = new_line + start_col;
-			for (col = 0; col < len; col++)
-			    ptr[col] = (col < num_tabs) ? '\t' : ' ';
-			ml_replace(lnum, new_line, FALSE);
-			if (first_line == 0)
-			    first_line = lnum;
-			last_line = lnum;
-			ptr = new_line;
-			col = start_col + len;
+			}
+			mch_memmove((char_u *)ga.ga_data + ga.ga_len,
+				ptr + done_col, (size_t)(start_col - done_col));
+			ga.ga_len += start_col - done_col;
+			for (temp = 0; temp < len; ++temp)
+			    ((char_u *)ga.ga_data)[ga.ga_len++] =
+						  temp < num_tabs ? TAB : ' ';
+			done_col = col;
 		    }
 		}
 		got_tab = FALSE;
@@ -679,10 +851,33 @@ ex_retab(eap)
 #endif
 		++col;
 	}
-	if (new_line == NULL)		    /* out of memory */
+	if (!failed && done_col >= 0)
+	{
+	    /* Add the rest of the line, including the NUL. */
+	    len = (long)STRLEN(ptr + done_col) + 1;
+	    if (ga_grow(&ga, (int)len) == FAIL)
+		failed = TRUE;
+	    else
+	    {
+		mch_memmove((char_u *)ga.ga_data + ga.ga_len,
+					       ptr + done_col, (size_t)len);
+		if (sub_stage_add(&staged, lnum, ga.ga_data) == FAIL)
+		    failed = TRUE;
+		else
+		{
+		    if (first_line == 0)
+			first_line = lnum;
+		    last_line = lnum;
+		}
+	    }
+	}
+	if (failed)			    /* out of memory */
 	    break;
 	line_breakcheck();
     }
+    (void)sub_stage_flush(&staged);
+    ga_clear(&staged);
+    ga_clear(&ga);
     if (got_int)
 	EMSG(_(e_interr));
 
@@ -1039,8 +1234,8 @@ do_bang(addr_count, eap, forceit, do_in, do_out)
  * at the PATH env. variable, and adding reasonable extensions to the
  * command name given by the user. All reasonable versions of call_shell()
  * do this.
- * Alternatively, if on Unix and redirecting input or output, but not both,
- * and the 'shelltemp' option isn't set, use pipes.
+ * Alternatively, if on Unix or Plan 9 and the 'shelltemp' option isn't set,
+ * use pipes.
  * We use input redirection if do_in is TRUE.
  * We use output redirection if do_out is TRUE.
  */
@@ -1096,7 +1291,7 @@ do_filter(line1, line2, eap, cmd, do_in, do_out)
     if (do_out)
 	shell_flags |= SHELL_DOOUT;
 
-#if !defined(USE_SYSTEM) && defined(UNIX)
+#if !defined(USE_SYSTEM) && (defined(UNIX) || defined(PLAN9))
     if (!do_in && do_out && !p_stmp)
     {
 	/* Use a pipe to fetch stdout of the command, do not use a temp file. */
@@ -4124,6 +4319,69 @@ check_secure()
 static char_u	*old_sub = NULL;	/* previous substitute pattern */
 static int	global_need_beginline;	/* call beginline() after ":g" */
 
+/*
+ * Stage "line" as the new text for line "lnum".  Lines must be staged in
+ * increasing order.  When "lnum" is too far away from the staged lines,
+ * those are put in the buffer first.
+ * Returns FAIL when out of memory or when saving for undo failed.
+ */
+    static int
+sub_stage_add(gap, lnum, line)
+    garray_T	*gap;
+    linenr_T	lnum;
+    char_u	*line;
+{
+    substage_T	*ss;
+    char_u	*p;
+
+    if (gap->ga_len > 0)
+    {
+	ss = (substage_T *)gap->ga_data;
+	if ((lnum - ss[0].ss_lnum >= SUB_STAGE_MAX
+		    || lnum - ss[gap->ga_len - 1].ss_lnum > SUB_STAGE_GAP)
+		&& sub_stage_flush(gap) == FAIL)
+	    return FAIL;
+    }
+    p = vim_strsave(line);
+    if (p == NULL || ga_grow(gap, 1) == FAIL)
+    {
+	vim_free(p);
+	return FAIL;
+    }
+    ss = (substage_T *)gap->ga_data + gap->ga_len++;
+    ss->ss_lnum = lnum;
+    ss->ss_line = p;
+    return OK;
+}
+
+/*
+ * Put the staged lines in the buffer, after saving the block of lines they
+ * are in for undo.  Returns FAIL when saving for undo failed, the staged
+ * changes are then dropped.
+ */
+    static int
+sub_stage_flush(gap)
+    garray_T	*gap;
+{
+    substage_T	*ss = (substage_T *)gap->ga_data;
+    int		retval = OK;
+    int		i;
+
+    if (gap->ga_len == 0)
+	return OK;
+    if (u_save(ss[0].ss_lnum - 1, ss[gap->ga_len - 1].ss_lnum + 1) == FAIL)
+	retval = FAIL;
+    for (i = 0; i < gap->ga_len; ++i)
+    {
+	if (retval == OK)
+	    ml_replace(ss[i].ss_lnum, ss[i].ss_line, FALSE);
+	else
+	    vim_free(ss[i].ss_line);
+    }
+    gap->ga_len = 0;
+    return retval;
+}
+
 /* do_sub()
  *
  * Perform a substitution from line eap->line1 to line eap->line2 using the
@@ -4167,6 +4425,8 @@ do_sub(eap)
     char_u	*sub_firstline;		/* allocated copy of first sub line */
     int		endcolumn = FALSE;	/* cursor in last column when done */
     pos_T	old_cursor = curwin->w_cursor;
+    int		stage;			/* stage changed lines */
+    garray_T	staged;			/* staged changes, substage_T */
 
     cmd = eap->arg;
     if (!global_busy)
@@ -4392,6 +4652,13 @@ do_sub(eap)
 
     sub_firstline = NULL;
 
+    /* Changed lines can be staged when matching in the following lines
+     * doesn't see them: no look-behind and no expression, it might use
+     * getline().  Not when asking, each change must be visible. */
+    stage = !do_ask && !re_lookbehind(regmatch.regprog)
+					&& !(sub[0] == '\\' && sub[1] == '=');
+    ga_init2(&staged, (int)sizeof(substage_T), 100);
+
     /*
      * ~ in the substitute pattern is replaced with the old pattern.
      * We do it here once to avoid it to be replaced over and over again.
@@ -4411,7 +4678,8 @@ do_sub(eap)
 		); ++lnum)
     {
 	sub_firstlnum = lnum;
-	nmatch = vim_regexec_multi(&regmatch, curwin, curbuf, lnum, (colnr_T)0);
+	nmatch = vim_regexec_multi(&regmatch, curwin, curbuf, lnum,
+							    (colnr_T)0, NULL);
 	if (nmatch)
 	{
 	    colnr_T	copycol;
@@ -4830,7 +5098,9 @@ do_sub(eap)
 			mch_memmove(p1, p1 + 1, STRLEN(p1));
 		    else if (*p1 == CAR)
 		    {
-			if (u_inssub(lnum) == OK)   /* prepare for undo */
+			/* Staged lines go first, line numbers change. */
+			if (sub_stage_flush(&staged) == OK
+				&& u_inssub(lnum) == OK) /* prepare for undo */
 			{
 			    *p1 = NUL;		    /* truncate up to the CR */
 			    ml_append(lnum - 1, new_start,
@@ -4892,7 +5162,7 @@ skip:
 			|| (do_ask && !re_lookbehind(regmatch.regprog))
 			|| nmatch_tl > 0
 			|| (nmatch = vim_regexec_multi(&regmatch, curwin,
-				       curbuf, sub_firstlnum, matchcol)) == 0)
+				 curbuf, sub_firstlnum, matchcol, NULL)) == 0)
 		{
 		    if (new_start != NULL)
 		    {
@@ -4908,9 +5178,18 @@ skip:
 			prev_matchcol = (colnr_T)STRLEN(sub_firstline)
 							      - prev_matchcol;
 
-			if (u_savesub(lnum) != OK)
-			    break;
-			ml_replace(lnum, new_start, TRUE);
+			if (stage && nmatch_tl == 0)
+			{
+			    if (sub_stage_add(&staged, lnum, new_start) == FAIL)
+				break;
+			}
+			else
+			{
+			    if (sub_stage_flush(&staged) == FAIL
+						    || u_savesub(lnum) != OK)
+				break;
+			    ml_replace(lnum, new_start, TRUE);
+			}
 
 			if (nmatch_tl > 0)
 			{
@@ -4956,7 +5235,7 @@ skip:
 		    }
 		    if (nmatch == -1 && !lastone)
 			nmatch = vim_regexec_multi(&regmatch, curwin, curbuf,
-						     sub_firstlnum, matchcol);
+					       sub_firstlnum, matchcol, NULL);
 
 		    /*
 		     * 5. break if there isn't another match in this line
@@ -4977,6 +5256,7 @@ skip:
 	line_breakcheck();
     }
 
+    (void)sub_stage_flush(&staged);
     if (first_line != 0)
     {
 	/* Need to subtract the number of added lines from "last_line" to get
@@ -4988,6 +5268,8 @@ skip:
 
 outofmem:
     vim_free(sub_firstline); /* may have to free allocated copy of the line */
+    (void)sub_stage_flush(&staged);
+    ga_clear(&staged);
 
     /* ":s/pat//n" doesn't move the cursor */
     if (do_count)
@@ -5108,7 +5390,7 @@ ex_global(eap)
     char_u	delim;		/* delimiter, normally '/' */
     char_u	*pat;
     regmmatch_T	regmatch;
-    int		match;
+    linenr_T	next;		/* next line with a match */
     int		which_pat;
 
     if (global_busy)
@@ -5178,14 +5460,25 @@ ex_global(eap)
      */
     for (lnum = eap->line1; lnum <= eap->line2 && !got_int; ++lnum)
     {
-	/* a match on this line? */
-	match = vim_regexec_multi(&regmatch, curwin, curbuf, lnum, (colnr_T)0);
-	if ((type == 'g' && match) || (type == 'v' && !match))
+	/* find the next line with a match, skipping lines without one */
+	next = vim_regexec_lines(&regmatch, curwin, curbuf, lnum, eap->line2,
+								  NULL, NULL);
+	if (got_int)
+	    break;
+	if (type == 'v')
+	    for ( ; lnum < (next == 0 ? eap->line2 + 1 : next); ++lnum)
+	    {
+		ml_setmarked(lnum);
+		ndone++;
+	    }
+	if (next == 0)
+	    break;
+	lnum = next;
+	if (type == 'g')
 	{
 	    ml_setmarked(lnum);
 	    ndone++;
 	}
-	line_breakcheck();
     }
 
     /*
@@ -5207,6 +5500,112 @@ ex_global(eap)
     vim_free(regmatch.regprog);
 }
 
+#define GLOBAL_KEEP	9	/* nr of lines deleted by ":d", for "1 - "9 */
+#define GLOBAL_RUN_MAX	1000	/* max nr of lines deleted at once */
+
+/*
+ * Return TRUE when "cmd" is a plain ":delete", without a register, count or
+ * following command.
+ */
+    static int
+global_is_delete(cmd)
+    char_u	*cmd;
+{
+    char_u	*p = cmd;
+    char_u	*d = (char_u *)"delete";
+
+    while (*p == ':' || vim_iswhite(*p))
+	++p;
+    if (*p != 'd')
+	return FALSE;
+    while (*p != NUL && *p == *d)
+    {
+	++p;
+	++d;
+    }
+    return *skipwhite(p) == NUL;
+}
+
+/*
+ * Delete lines marked with ml_setmarked() for ":g/pat/d": runs of marked
+ * lines are deleted at once, which is much faster than deleting them one by
+ * one, with a mark_adjust() and an undo entry for every line.  The last
+ * GLOBAL_KEEP lines are marked again, they are deleted by executing ":d" so
+ * that the numbered registers end up like when deleting every line.
+ */
+    static void
+global_delete_bulk()
+{
+    linenr_T	keep[GLOBAL_KEEP];	/* last marked lines */
+    int		nkeep = 0;
+    linenr_T	first = 0;		/* first line of the current run */
+    linenr_T	last = 0;		/* last line of the current run */
+    linenr_T	lnum;
+    linenr_T	l;
+    long	n;
+    int		i;
+
+    for (;;)
+    {
+	lnum = 0;
+	if (!got_int && global_busy == 1)
+	    lnum = ml_firstmarked();
+	else if (got_int)
+	    break;
+
+	/* When all kept lines are used the oldest one goes to the run. */
+	l = 0;
+	if (lnum != 0 && nkeep == GLOBAL_KEEP)
+	{
+	    l = keep[0];
+	    for (i = 1; i < nkeep; ++i)
+		keep[i - 1] = keep[i];
+	    --nkeep;
+	}
+
+	/* Delete the run when it ends or gets too long. */
+	if (first != 0 && (l != last + 1 || last - first + 1 >= GLOBAL_RUN_MAX))
+	{
+	    n = curbuf->b_ml.ml_line_count;
+	    curwin->w_cursor.lnum = first;
+	    del_lines((long)(last - first + 1), TRUE);
+	    n -= curbuf->b_ml.ml_line_count;
+	    if (n == 0)
+	    {
+		/* Deleting failed, leave the rest to ":d". */
+		for ( ; first <= last; ++first)
+		    ml_setmarked(first);
+		if (l != 0)
+		    ml_setmarked(l);
+		if (lnum != 0)
+		    ml_setmarked(lnum);
+		break;
+	    }
+	    for (i = 0; i < nkeep; ++i)
+		keep[i] -= n;
+	    if (l != 0)
+		l -= n;
+	    if (lnum != 0)
+		lnum -= n;
+	    first = 0;
+	}
+	if (l != 0)
+	{
+	    if (first == 0)
+		first = l;
+	    last = l;
+	}
+
+	if (lnum == 0)
+	    break;
+	keep[nkeep++] = lnum;
+	fast_breakcheck();
+    }
+
+    for (i = 0; i < nkeep; ++i)
+	ml_setmarked(keep[i]);
+}
+
 /*
  * Execute "cmd" on lines marked with ml_setmarked().
  */
@@ -5230,6 +5629,9 @@ global_exe(cmd)
     global_need_beginline = FALSE;
     global_busy = 1;
     old_lcount = curbuf->b_ml.ml_line_count;
+    if (curbuf->b_p_ma && global_is_delete(cmd))
+	global_delete_bulk();
+
     while (!got_int && (lnum = ml_firstmarked()) != 0 && global_busy == 1)
     {
 	curwin->w_cursor.lnum = lnum;
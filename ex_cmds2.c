@@ -889,6 +889,83 @@ profile_msg(tm)
     return buf;
 }
 
+/*
+ * Put the time "msec" past now in "tm".  Zero or less means no limit.
+ */
+    void
+profile_setlimit(msec, tm)
+    long	msec;
+    proftime_T	*tm;
+{
+    if (msec <= 0)
+    {
+# ifdef WIN3264
+	tm->QuadPart = 0;
+# else
+	tm->tv_usec = 0;
+	tm->tv_sec = 0;
+# endif
+    }
+    else
+    {
+# ifdef WIN3264
+	LARGE_INTEGER	fr;
+
+	QueryPerformanceCounter(tm);
+	QueryPerformanceFrequency(&fr);
+	tm->QuadPart += (LONGLONG)((double)msec / 1000.0
+							* (double)fr.QuadPart);
+# else
+	long	    usec;
+
+	gettimeofday(tm, NULL);
+	usec = (long)tm->tv_usec + msec * 1000L;
+	tm->tv_usec = usec % 1000000L;
+	tm->tv_sec += usec / 1000000L;
+# endif
+    }
+}
+
+/*
+ * Return TRUE if the current time is past "tm", set with profile_setlimit().
+ */
+    int
+profile_passed_limit(tm)
+    proftime_T	*tm;
+{
+    proftime_T	now;
+
+# ifdef WIN3264
+    if (tm->QuadPart == 0)	/* no limit */
+	return FALSE;
+    QueryPerformanceCounter(&now);
+    return (now.QuadPart > tm->QuadPart);
+# else
+    if (tm->tv_sec == 0)	/* no limit */
+	return FALSE;
+    gettimeofday(&now, NULL);
+    return (now.tv_sec > tm->tv_sec
+		|| (now.tv_sec == tm->tv_sec && now.tv_usec > tm->tv_usec));
+# endif
+}
+
+/*
+ * Return the time "tm", as computed by profile_end(), in msec.
+ */
+    long
+profile_msec(tm)
+    proftime_T	*tm;
+{
+# ifdef WIN3264
+    LARGE_INTEGER   fr;
+
+    QueryPerformanceFrequency(&fr);
+    return (long)(tm->QuadPart * 1000 / fr.QuadPart);
+# else
+    return (long)tm->tv_sec * 1000L + (long)tm->tv_usec / 1000L;
+# endif
+}
+
 # endif  /* FEAT_PROFILE || FEAT_RELTIME */
 
 # if defined(FEAT_PROFILE) || defined(PROTO)
@@ -934,6 +1011,30 @@ profile_add(tm, tm2)
 # endif
 }
 
+/*
+ * Divide the time "tm" by "count" and store in "tm2".
+ */
+    void
+profile_divide(tm, count, tm2)
+    proftime_T	*tm;
+    long	count;
+    proftime_T	*tm2;
+{
+    if (count == 0)
+	profile_zero(tm2);
+    else
+    {
+# ifdef WIN3264
+	tm2->QuadPart = tm->QuadPart / count;
+# else
+	double usec = (tm->tv_sec * 1000000.0 + tm->tv_usec) / count;
+
+	tm2->tv_sec = (long)(usec / 1000000.0);
+	tm2->tv_usec = (long)(usec - tm2->tv_sec * 1000000.0);
+# endif
+    }
+}
+
 /*
  * Add the "self" time from the total time and the children's time.
  */
@@ -236,6 +236,7 @@ static void	ex_popup __ARGS((exarg_T *eap));
 #endif
 #ifndef FEAT_SYN_HL
 # define ex_syntax		ex_ni
+# define ex_syntime		ex_ni
 #endif
 #ifndef FEAT_SPELL
 # define ex_spell		ex_ni
@@ -3874,7 +3875,7 @@ get_address(ptr, skip, to_other_file)
 				curwin->w_cursor.col = 0;
 			    searchcmdlen = 0;
 			    if (!do_search(NULL, c, cmd, 1L,
-				      SEARCH_HIS + SEARCH_MSG + SEARCH_START))
+				SEARCH_HIS + SEARCH_MSG + SEARCH_START, NULL))
 			    {
 				curwin->w_cursor = pos;
 				cmd = NULL;
@@ -3923,7 +3924,7 @@ get_address(ptr, skip, to_other_file)
 					*cmd == '?' ? BACKWARD : FORWARD,
 					(char_u *)"", 1L,
 					SEARCH_MSG + SEARCH_START,
-						      i, (linenr_T)0) != FAIL)
+						i, (linenr_T)0, NULL) != FAIL)
 				lnum = pos.lnum;
 			    else
 			    {
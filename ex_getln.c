@@ -1710,11 +1710,17 @@ cmdline_changed:
 		i = 0;
 	    else
 	    {
+		regbudget_T	budget;
+
+		/* Don't let a slow pattern block typing: give up after a
+		 * quarter of 'redrawtime', as if there was no match. */
+		regbudget_init(&budget, p_rdt / 4);
 		cursor_off();		/* so the user knows we're busy */
 		out_flush();
 		++emsg_off;    /* So it doesn't beep if bad expr */
 		i = do_search(NULL, firstc, ccline.cmdbuff, count,
-			SEARCH_KEEP + SEARCH_OPT + SEARCH_NOOF + SEARCH_PEEK);
+			SEARCH_KEEP + SEARCH_OPT + SEARCH_NOOF + SEARCH_PEEK,
+								     &budget);
 		--emsg_off;
 		/* if interrupted while searching, behave like it failed */
 		if (got_int)
@@ -2194,6 +2194,12 @@ failed:
 	if (newfile || read_buffer)
 	{
 	    redraw_curbuf_later(NOT_VALID);
+	    /* The text was replaced without changing b_changedtick. */
+	    vcol_cache_buf_clear(curbuf);
+	    plines_cache_buf_clear(curbuf);
+#ifdef FEAT_SEARCH_EXTRA
+	    search_idx_free(curbuf);
+#endif
 #ifdef FEAT_DIFF
 	    /* After reading the text into the buffer the diff info needs to
 	     * be updated. */
@@ -124,6 +124,7 @@ static void	init_typebuf __ARGS((void));
 static void	gotchars __ARGS((char_u *, int));
 static void	may_sync_undo __ARGS((void));
 static void	closescript __ARGS((void));
+static long	idle_work __ARGS((long wait_time));
 static int	vgetorpeek __ARGS((int));
 static void	map_free __ARGS((mapblock_T **));
 static void	validate_maphash __ARGS((void));
@@ -1462,6 +1463,62 @@ before_blocking()
 #endif
 }
 
+/*
+ * Do work that can wait until the user stops typing, in small steps, until a
+ * character is available or "wait_time" msec have passed (-1 for no limit).
+ * Only in Normal and Insert mode, other states may have pointers into the
+ * buffer that must stay valid.
+ * Returns what is left of "wait_time".
+ */
+    static long
+idle_work(wait_time)
+    long	wait_time;
+{
+    int		more;
+#ifdef FEAT_RELTIME
+    proftime_T	start;
+    proftime_T	tm;
+    long	elapsed = 0;
+#endif
+
+    if (!(State & (NORMAL | INSERT)) || State >= HITRETURN)
+	return wait_time;
+#ifndef FEAT_RELTIME
+    /* Can't tell how long the work takes, only do it when waiting forever. */
+    if (wait_time >= 0)
+	return wait_time;
+#else
+    profile_start(&start);
+#endif
+    do
+    {
+	more = FALSE;
+#ifdef FEAT_SEARCH_EXTRA
+	if (search_idx_idle())
+	    more = TRUE;
+#endif
+#ifdef FEAT_SYN_HL
+	if (syn_idle())
+	    more = TRUE;
+#endif
+#ifdef FEAT_RELTIME
+	if (wait_time >= 0)
+	{
+	    tm = start;
+	    profile_end(&tm);
+	    elapsed = profile_msec(&tm);
+	    if (elapsed >= wait_time)
+		return 0L;
+	}
+#endif
+    } while (more && !got_int && !ui_char_avail());
+#ifdef FEAT_RELTIME
+    if (wait_time >= 0)
+	return wait_time - elapsed;
+#endif
+    return wait_time;
+}
+
 /*
  * updatescipt() is called when a character can be written into the script file
  * or when we have waited some time for a character (c == 0)
@@ -2892,9 +2949,15 @@ inchar(buf, maxlen, wait_time, tb_change_cnt)
 
 	/*
 	 * Always flush the output characters when getting input characters
-	 * from the user.
+	 * from the user and not just peeking.  Flushing when peeking would
+	 * split up a screen update in pieces.
 	 */
-	out_flush();
+	if (wait_time == -1L || wait_time > 10L)
+	    out_flush();
+
+	/* Use the time until a key is typed for background work. */
+	if (wait_time < 0 || wait_time > 100L)
+	    wait_time = idle_work(wait_time);
 
 	/*
 	 * Fill up to a third of the buffer, because each character may be
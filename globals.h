@@ -963,6 +963,8 @@ EXTERN int	maptick INIT(= 0);	/* tick for each non-mapped char */
 
 EXTERN char_u	chartab[256];		/* table used in charset.c; See
 					   init_chartab() for explanation */
+EXTERN int	chartab_tick INIT(= 0);	/* incremented when chartab[] is
+					   filled again */
 
 EXTERN int	must_redraw INIT(= 0);	    /* type of redraw necessary */
 EXTERN int	skip_redraw INIT(= FALSE);  /* skip redraw once */
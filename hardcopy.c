@@ -90,6 +90,8 @@ static const long_u  cterm_color_16[16] =
 };
 
 static int		current_syn_id;
+static garray_T		prt_syn_ids;	/* syntax ID for each byte */
+static linenr_T		prt_syn_lnum;	/* line of "prt_syn_ids" */
 #endif
 
 #define PRCOLOR_BLACK	(long_u)0
@@ -672,6 +674,8 @@ ex_hardcopy(eap)
     prt_set_font(FALSE, FALSE, FALSE);
 #ifdef FEAT_SYN_HL
     current_syn_id = -1;
+    ga_init2(&prt_syn_ids, (int)sizeof(int), 200);
+    prt_syn_lnum = 0;
 #endif
 
     jobsplit = (printer_opts[OPT_PRINT_JOBSPLIT].present
@@ -818,6 +822,9 @@ print_fail:
     mch_print_end(&settings);
 
 print_fail_no_begin:
+#ifdef FEAT_SYN_HL
+    ga_clear(&prt_syn_ids);
+#endif
     mch_print_cleanup();
 }
 
@@ -858,6 +865,21 @@ hardcopy_line(psettings, page_line, ppos)
     }
 
     mch_print_start_line(0, page_line);
+#ifdef FEAT_SYN_HL
+    /*
+     * Get the syntax IDs for the whole line at once.  When the line is
+     * continued on the next page line they are used again.
+     */
+    if (psettings->do_syntax && prt_syn_lnum != ppos->file_line)
+    {
+	prt_syn_ids.ga_len = 0;
+	if (syn_get_line_ids(curwin, ppos->file_line, TRUE, &prt_syn_ids)
+									== OK)
+	    prt_syn_lnum = ppos->file_line;
+	else
+	    prt_syn_lnum = 0;
+    }
+#endif
     line = ml_get(ppos->file_line);
 
     /*
@@ -876,13 +898,14 @@ hardcopy_line(psettings, page_line, ppos)
 	 */
 	if (psettings->do_syntax)
 	{
-	    id = syn_get_id(curwin, ppos->file_line, col, 1, NULL);
+	    if (prt_syn_lnum == ppos->file_line && col < prt_syn_ids.ga_len)
+		id = ((int *)prt_syn_ids.ga_data)[col];
+	    else
+		id = 0;
 	    if (id > 0)
 		id = syn_get_final_id(id);
 	    else
 		id = 0;
-	    /* Get the line again, a multi-line regexp may invalidate it. */
-	    line = ml_get(ppos->file_line);
 
 	    if (id != current_syn_id)
 	    {
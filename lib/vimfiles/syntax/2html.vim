@@ -367,6 +367,11 @@ while s:lnum <= s:end
 
     " Get the diff attribute, if any.
     let s:diffattr = diff_hlID(s:lnum, 1)
+    if !s:diffattr
+      " Get the runs of text with the same synID for the whole line at once
+      let s:runs = synIDruns(s:lnum, 1)
+      let s:run = 0
+    endif
 
     " Loop over each character in the line
     let s:col = 1
@@ -384,11 +389,10 @@ while s:lnum <= s:end
 	  let s:len = &columns
 	endif
       else
-	let s:id = synID(s:lnum, s:col, 1)
-	let s:col = s:col + 1
-	" Speed loop (it's small - that's the trick)
-	" Go along till we find a change in synID
-	while s:col <= s:len && s:id == synID(s:lnum, s:col, 1) | let s:col = s:col + 1 | endwhile
+	" Each run is [col, len, synID]
+	let s:id = s:runs[s:run][2]
+	let s:col = s:col + s:runs[s:run][1]
+	let s:run = s:run + 1
       endif
 
       " Expand tabs
@@ -533,6 +537,7 @@ unlet s:htmlfont
 unlet s:old_et s:old_paste s:old_icon s:old_report s:old_title s:old_search
 unlet s:whatterm s:idlist s:lnum s:end s:fgc s:bgc s:old_magic
 unlet! s:col s:id s:attr s:len s:line s:new s:expandedtab s:numblines
+unlet! s:runs s:run
 unlet s:orgwin s:newwin s:orgbufnr
 if !v:profiling
   delfunc s:HtmlColor
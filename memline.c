@@ -4491,6 +4491,8 @@ ml_updatechunk(buf, line, len, updtype)
 	buf->b_ml.ml_usedchunks = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize = 1;
+	buf->b_ml.ml_hintline = 1;
+	buf->b_ml.ml_hintix = 0;
     }
 
     if (updtype == ML_CHNK_UPDLINE && buf->b_ml.ml_line_count == 1)
@@ -4499,6 +4501,8 @@ ml_updatechunk(buf, line, len, updtype)
 	 * First line in empty buffer from ml_flush_line() -- reset
 	 */
 	buf->b_ml.ml_usedchunks = 1;
+	buf->b_ml.ml_hintline = 1;
+	buf->b_ml.ml_hintix = 0;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize =
 				  (long)STRLEN(buf->b_ml.ml_line_ptr) + 1;
@@ -4512,7 +4516,21 @@ ml_updatechunk(buf, line, len, updtype)
     if (buf != ml_upd_lastbuf || line != ml_upd_lastline + 1
 	    || updtype != ML_CHNK_ADDLINE)
     {
-	for (curline = 1, curix = 0;
+	/* Start at the hint when the line is not above it, the chunks above
+	 * it didn't change.  Avoids going over all chunks for every line when
+	 * deleting many lines in a big buffer. */
+	if (line >= buf->b_ml.ml_hintline
+		&& buf->b_ml.ml_hintix < buf->b_ml.ml_usedchunks)
+	{
+	    curline = buf->b_ml.ml_hintline;
+	    curix = buf->b_ml.ml_hintix;
+	}
+	else
+	{
+	    curline = 1;
+	    curix = 0;
+	}
+	for ( ;
 	     curix < buf->b_ml.ml_usedchunks - 1
 	     && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines;
 	     curix++)
@@ -4529,8 +4547,28 @@ ml_updatechunk(buf, line, len, updtype)
     }
     curchnk = buf->b_ml.ml_chunksize + curix;
 
+    /* Only the chunk at "curix" and the ones below it are changed.  When
+     * deleting it may be joined with the chunk above it, which keeps its
+     * start. */
+    if (updtype != ML_CHNK_DELLINE)
+    {
+	buf->b_ml.ml_hintline = curline;
+	buf->b_ml.ml_hintix = curix;
+    }
+    else if (curix > 0)
+    {
+	buf->b_ml.ml_hintline = curline - curchnk[-1].mlcs_numlines;
+	buf->b_ml.ml_hintix = curix - 1;
+    }
+    else
+    {
+	buf->b_ml.ml_hintline = 1;
+	buf->b_ml.ml_hintix = 0;
+    }
+
     if (updtype == ML_CHNK_DELLINE)
 	len = -len;
+
     curchnk->mlcs_totalsize += len;
     if (updtype == ML_CHNK_ADDLINE)
     {
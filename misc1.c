@@ -21,6 +21,8 @@
 static char_u *vim_version_dir __ARGS((char_u *vimdir));
 static char_u *remove_tail __ARGS((char_u *p, char_u *pend, char_u *name));
 static int copy_indent __ARGS((int size, char_u	*src));
+static plines_cache_T *plines_cache_get __ARGS((win_T *wp));
+static int plines_win_count __ARGS((win_T *wp, linenr_T lnum));
 
 /*
  * Count the size (in window cells) of the indent in the current line.
@@ -398,7 +400,8 @@ get_number_indent(lnum)
     {
 	regmatch.rmm_ic = FALSE;
 	regmatch.rmm_maxcol = 0;
-	if (vim_regexec_multi(&regmatch, curwin, curbuf, lnum, (colnr_T)0))
+	if (vim_regexec_multi(&regmatch, curwin, curbuf, lnum,
+							    (colnr_T)0, NULL))
 	{
 	    pos.lnum = regmatch.endpos[0].lnum + lnum;
 	    pos.col = regmatch.endpos[0].col;
@@ -1674,11 +1677,150 @@ plines_win_nofill(wp, lnum, winheight)
 /*
  * Return number of window lines physical line "lnum" will occupy in window
  * "wp".  Does not care about folding, 'wrap' or 'diff'.
+ * Uses the line height cache of "wp", scrolling asks for the same lines many
+ * times and a long line takes a while to measure.
  */
     int
 plines_win_nofold(wp, lnum)
     win_T	*wp;
     linenr_T	lnum;
+{
+    plines_cache_T	*plc;
+    int			idx = (int)(lnum % PLC_SIZE);
+    int			lines;
+
+    plc = plines_cache_get(wp);
+    if (plc != NULL && plc->plc_lnum[idx] == lnum)
+	return plc->plc_lines[idx];
+
+    lines = plines_win_count(wp, lnum);
+    if (plc != NULL)
+    {
+	plc->plc_lnum[idx] = lnum;
+	plc->plc_lines[idx] = lines;
+    }
+    return lines;
+}
+
+/*
+ * Get the line height cache of window "wp", allocating it when needed.
+ * Clears the cache when it is for another buffer, text or window width.
+ * Returns NULL when out of memory.
+ */
+    static plines_cache_T *
+plines_cache_get(wp)
+    win_T	*wp;
+{
+    plines_cache_T	*plc = wp->w_plines_cache;
+    buf_T		*buf = wp->w_buffer;
+    int			width = W_WIDTH(wp) - win_col_off(wp);
+    int			off2 = win_col_off2(wp);
+
+    if (plc == NULL)
+    {
+	plc = (plines_cache_T *)alloc_clear((unsigned)sizeof(plines_cache_T));
+	if (plc == NULL)
+	    return NULL;
+	wp->w_plines_cache = plc;
+    }
+
+    if (plc->plc_fnum != buf->b_fnum
+	    || plc->plc_changedtick != buf->b_changedtick
+	    || plc->plc_width != width
+	    || plc->plc_off2 != off2
+	    || plc->plc_ts != buf->b_p_ts
+	    || plc->plc_list != wp->w_p_list
+#ifdef FEAT_LINEBREAK
+	    || plc->plc_lbr != wp->w_p_lbr
+#endif
+	    )
+    {
+	vim_memset(plc->plc_lnum, 0, sizeof(plc->plc_lnum));
+	plc->plc_fnum = buf->b_fnum;
+	plc->plc_changedtick = buf->b_changedtick;
+	plc->plc_width = width;
+	plc->plc_off2 = off2;
+	plc->plc_ts = buf->b_p_ts;
+	plc->plc_list = wp->w_p_list;
+#ifdef FEAT_LINEBREAK
+	plc->plc_lbr = wp->w_p_lbr;
+#endif
+    }
+    return plc;
+}
+
+/*
+ * Remove lines "lnum" to "lnume" (not including) from the line height cache
+ * of window "wp" after they were changed.  When lines were inserted or
+ * deleted ("xtra" is not zero) the lines below the change move and are
+ * removed as well.  "tick" is b_changedtick from before the change.
+ */
+    void
+plines_cache_changed(wp, lnum, lnume, xtra, tick)
+    win_T	*wp;
+    linenr_T	lnum;
+    linenr_T	lnume;
+    long	xtra;
+    int		tick;
+{
+    plines_cache_T	*plc = wp->w_plines_cache;
+    int			i;
+
+    /* When the cache was for other text it is cleared when used. */
+    if (plc == NULL || plc->plc_fnum != wp->w_buffer->b_fnum
+					     || plc->plc_changedtick != tick)
+	return;
+
+    for (i = 0; i < PLC_SIZE; ++i)
+	if (plc->plc_lnum[i] >= lnum
+			       && (xtra != 0 || plc->plc_lnum[i] < lnume))
+	    plc->plc_lnum[i] = 0;
+    plc->plc_changedtick = wp->w_buffer->b_changedtick;
+}
+
+/*
+ * Clear the line height cache of all windows showing buffer "buf".  Used
+ * when its text was read again, b_changedtick doesn't change then.
+ */
+    void
+plines_cache_buf_clear(buf)
+    buf_T	*buf;
+{
+    win_T	*wp;
+#ifdef FEAT_WINDOWS
+    tabpage_T	*tp;
+#endif
+
+    FOR_ALL_TAB_WINDOWS(tp, wp)
+	if (wp->w_buffer == buf && wp->w_plines_cache != NULL)
+	    wp->w_plines_cache->plc_fnum = 0;
+}
+
+/*
+ * Clear the line height cache of all windows.  Used when an option changed
+ * that may change the height of lines.
+ */
+    void
+plines_cache_clear_all()
+{
+    win_T	*wp;
+#ifdef FEAT_WINDOWS
+    tabpage_T	*tp;
+#endif
+
+    FOR_ALL_TAB_WINDOWS(tp, wp)
+	if (wp->w_plines_cache != NULL)
+	    wp->w_plines_cache->plc_fnum = 0;
+}
+
+/*
+ * Compute the number of window lines physical line "lnum" uses in window
+ * "wp", for plines_win_nofold().
+ */
+    static int
+plines_win_count(wp, lnum)
+    win_T	*wp;
+    linenr_T	lnum;
 {
     char_u	*s;
     long	col;
@@ -2670,6 +2812,7 @@ changed_common(lnum, col, lnume, xtra)
 {
     win_T	*wp;
     int		i;
+    int		tick;
 #ifdef FEAT_JUMPLIST
     int		cols;
     pos_T	*p;
@@ -2677,6 +2820,7 @@ changed_common(lnum, col, lnume, xtra)
 #endif
 
     /* mark the buffer as modified */
+    tick = curbuf->b_changedtick;
     changed();
 
     /* set the '. mark */
@@ -2748,6 +2892,14 @@ changed_common(lnum, col, lnume, xtra)
 #endif
     }
 
+#ifdef FEAT_SEARCH_EXTRA
+    /* The changed lines must be scanned again for the match index. */
+    search_idx_changed(curbuf, lnum, lnume, xtra);
+#endif
+
+    /* Virtual column checkpoints after the change are invalid. */
+    vcol_cache_changed(lnum, col, lnume, xtra, tick);
+
     FOR_ALL_WINDOWS(wp)
     {
 	if (wp->w_buffer == curbuf)
@@ -2756,6 +2908,9 @@ changed_common(lnum, col, lnume, xtra)
 	    if (wp->w_redr_type < VALID)
 		wp->w_redr_type = VALID;
 
+	    /* The changed lines may have a different height now. */
+	    plines_cache_changed(wp, lnum, lnume, xtra, tick);
+
 	    /* Check if a change in the buffer has invalidated the cached
 	     * values for the cursor. */
 #ifdef FEAT_FOLDING
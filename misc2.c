@@ -205,7 +205,9 @@ coladvance2(pos, addspaces, finetune, wcol)
 #endif
 
 	idx = -1;
-	ptr = line;
+	/* In a long line start at a checkpoint, see vcol_checkpoint(). */
+	ptr = line + vcol_checkpoint(curwin, curwin->w_cursor.lnum, line,
+							   MAXCOL, wcol, &col);
 	while (col <= wcol && *ptr != NUL)
 	{
 	    /* Count a tab for what it's worth (if list mode not on) */
@@ -1031,6 +1033,7 @@ free_all_mem()
     free_regexp_stuff();
     free_tag_stuff();
     free_cd_dir();
+    vcol_cache_free();
     set_expr_line(NULL);
     diff_clear(curtab);
     clear_sb_text();	      /* free any scrollback text */
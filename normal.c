@@ -4178,7 +4178,7 @@ find_decl(ptr, len, locally, thisblock, searchflags)
     for (;;)
     {
 	t = searchit(curwin, curbuf, &curwin->w_cursor, FORWARD,
-				  pat, 1L, searchflags, RE_LAST, (linenr_T)0);
+			    pat, 1L, searchflags, RE_LAST, (linenr_T)0, NULL);
 	if (curwin->w_cursor.lnum >= old_pos.lnum)
 	    t = FAIL;	/* match after start is failure too */
 
@@ -5237,8 +5237,10 @@ nv_clear(cap)
 	ui_get_shellsize();
 #endif
 #ifdef FEAT_SYN_HL
-	/* Clear all syntax states to force resyncing. */
+	/* Clear all syntax states to force resyncing.  Also give syntax
+	 * highlighting that was too slow another chance. */
 	syn_stack_free_all(curbuf);
+	curbuf->b_syn_slow = FALSE;
 #endif
 	redraw_later(CLEAR);
     }
@@ -6076,7 +6078,7 @@ normal_search(cap, dir, pat, opt)
     curwin->w_set_curswant = TRUE;
 
     i = do_search(cap->oap, dir, pat, cap->count1,
-				 opt | SEARCH_OPT | SEARCH_ECHO | SEARCH_MSG);
+			   opt | SEARCH_OPT | SEARCH_ECHO | SEARCH_MSG, NULL);
     if (i == 0)
 	clearop(cap->oap);
     else
@@ -258,7 +258,7 @@ op_shift(oap, curs_top, amount)
 	    if (first_char != '#' || !preprocs_left())
 #endif
 	{
-	    shift_line(oap->op_type == OP_LSHIFT, p_sr, amount);
+	    shift_line(oap->op_type == OP_LSHIFT, p_sr, amount, FALSE);
 	}
 	++curwin->w_cursor.lnum;
     }
@@ -319,12 +319,15 @@ op_shift(oap, curs_top, amount)
 /*
  * shift the current line one shiftwidth left (if left != 0) or right
  * leaves cursor on first blank in the line
+ * When "call_changed_bytes" is FALSE the caller must call changed_lines()
+ * for the line, that is faster when shifting many lines.
  */
     void
-shift_line(left, round, amount)
+shift_line(left, round, amount, call_changed_bytes)
     int	left;
     int	round;
     int	amount;
+    int call_changed_bytes;
 {
     int		count;
     int		i, j;
@@ -366,7 +369,7 @@ shift_line(left, round, amount)
 	change_indent(INDENT_SET, count, FALSE, NUL);
     else
 #endif
-	(void)set_indent(count, SIN_CHANGED);
+	(void)set_indent(count, call_changed_bytes ? SIN_CHANGED : 0);
 }
 
 #if defined(FEAT_VISUALEXTRA) || defined(PROTO)
@@ -1989,6 +1989,13 @@ static struct vimoption
     {"redraw",	    NULL,   P_BOOL|P_VI_DEF,
 			    (char_u *)NULL, PV_NONE,
 			    {(char_u *)FALSE, (char_u *)0L}},
+    {"redrawtime",  "rdt",  P_NUM|P_VI_DEF,
+#if defined(FEAT_SEARCH_EXTRA) || defined(FEAT_SYN_HL)
+			    (char_u *)&p_rdt, PV_NONE,
+#else
+			    (char_u *)NULL, PV_NONE,
+#endif
+			    {(char_u *)2000L, (char_u *)0L}},
     {"remap",	    NULL,   P_BOOL|P_VI_DEF,
 			    (char_u *)&p_remap, PV_NONE,
 			    {(char_u *)TRUE, (char_u *)0L}},
@@ -7988,6 +7995,14 @@ set_num_option(opt_idx, varp, value, errbuf, errbuflen, opt_flags)
 	errmsg = e_positive;
 	p_report = 1;
     }
+#if defined(FEAT_SEARCH_EXTRA) || defined(FEAT_SYN_HL)
+    if (p_rdt < 0)
+    {
+	errmsg = e_positive;
+	p_rdt = 0;
+    }
+#endif
+
     if ((p_sj < -100 || p_sj >= Rows) && full_screen)
     {
 	if (Rows != old_Rows)	/* Rows changed, just adjust p_sj */
@@ -8057,7 +8072,13 @@ check_redraw(flags)
 #endif
 
     if ((flags & P_RBUF) || (flags & P_RWIN) || all)
+    {
 	changed_window_setting();
+	/* The size of characters and the height of lines may have changed in
+	 * any window. */
+	vcol_cache_clear();
+	plines_cache_clear_all();
+    }
     if (flags & P_RBUF)
 	redraw_curbuf_later(NOT_VALID);
     if (clear)
@@ -1196,19 +1196,163 @@ void mch_setmouse(int) {
 }
 #endif
 
+/*
+ * Write the lines '[ to '] of the current buffer to "fd", for filtering with
+ * a pipe.  The lines are collected in a buffer to avoid a write() per line.
+ * NL in the buffer stands for a NUL byte.
+ */
+static void shell_write_lines(int fd) {
+    char_u buf[8192];
+    int len = 0;
+    linenr_T lnum;
+    char_u *p;
+
+    for (lnum = curbuf->b_op_start.lnum; lnum <= curbuf->b_op_end.lnum;
+								    ++lnum) {
+	for (p = ml_get(lnum); ; ++p) {
+	    if (len == sizeof(buf)) {
+		if (write(fd, buf, len) != len)
+		    return;
+		len = 0;
+	    }
+	    if (*p == NUL)
+		break;
+	    buf[len++] = *p == NL ? NUL : *p;
+	}
+	/* Like the file is written: no NL after the last line when 'binary'
+	 * is set and 'endofline' isn't. */
+	if (lnum != curbuf->b_op_end.lnum
+		|| !curbuf->b_p_bin
+		|| (lnum != write_no_eol_lnum
+		    && (lnum != curbuf->b_ml.ml_line_count
+			|| curbuf->b_p_eol)))
+	    buf[len++] = NL;
+    }
+    if (len > 0)
+	write(fd, buf, len);
+}
+
+/*
+ * Read the output of a filter from "fd" and append it as lines below the
+ * cursor line, moving the cursor to the last line.  NUL bytes are stored as
+ * NL.  An incomplete last line is appended as well.
+ */
+static void shell_read_lines(int fd) {
+    char_u buf[8192];
+    garray_T ga;	/* line that didn't fit in one read() */
+    char_u *p;
+    char_u *q;
+    char_u *s;
+    char_u *end;
+    char_u *line;
+    int len;
+    int n;
+
+    ga_init2(&ga, 1, 256);
+    while (!got_int && (n = read(fd, buf, sizeof(buf))) > 0) {
+	end = buf + n;
+	for (p = buf; p < end; p = s + 1) {
+	    s = memchr(p, NL, end - p);
+	    if (s == NULL)
+		s = end;
+	    for (q = p; q < s; ++q)
+		if (*q == NUL)
+		    *q = NL;
+	    if (s == end || ga.ga_len > 0) {
+		/* Collect the line in "ga" until its NL was read. */
+		if (ga_grow(&ga, (int)(s - p) + 1) == FAIL)
+		    break;
+		mch_memmove((char_u *)ga.ga_data + ga.ga_len, p, s - p);
+		ga.ga_len += (int)(s - p);
+		if (s == end)
+		    break;
+		line = ga.ga_data;
+		len = ga.ga_len;
+		ga.ga_len = 0;
+	    } else {
+		line = p;
+		len = (int)(s - p);
+	    }
+	    line[len] = NUL;
+	    if (ml_append(curwin->w_cursor.lnum, line, (colnr_T)(len + 1),
+								FALSE) == FAIL)
+		break;
+	    ++curwin->w_cursor.lnum;
+	}
+
+	fast_breakcheck();
+    }
+    if (ga.ga_len > 0 && ga_grow(&ga, 1) == OK) {
+	((char_u *)ga.ga_data)[ga.ga_len] = NUL;
+	if (ml_append(curwin->w_cursor.lnum, ga.ga_data, (colnr_T)0, FALSE)
+									== OK)
+	    ++curwin->w_cursor.lnum;
+    }
+    ga_clear(&ga);
+}
+
+/*
+ * Close the ends of the pipes for mch_call_shell() that are still open.
+ */
+static void
+close_pipes(int *tochild, int *fromchild)
+{
+    int i;
+
+    for (i = 0; i < 2; ++i) {
+	if (tochild[i] >= 0)
+	    close(tochild[i]);
+	if (fromchild[i] >= 0)
+	    close(fromchild[i]);
+    }
+}
+
+/*
+ * Execute "cmd" with rc.  When "options" has SHELL_WRITE the lines '[ to ']
+ * are written to its stdin, when it has SHELL_READ its stdout is appended
+ * below the cursor line.  No temp files are used then.  With both, the lines
+ * are written by a separate process, so that the command can produce output
+ * while its input is being written.
+ */
 int
 mch_call_shell(char_u *cmd, int options)
 {
     pid_t pid;
+    pid_t wpid = 0;
     int status;
+    int tochild[2];	/* pipe for stdin of the command */
+    int fromchild[2];	/* pipe for stdout of the command */
+    memfile_T *mfp;
+    int fd;
+    void (*savepipe)(int);
 
     if(options & SHELL_COOKED)
 	settmode(TMODE_COOK);
 
+    tochild[0] = tochild[1] = fromchild[0] = fromchild[1] = -1;
+    if (((options & SHELL_WRITE) && pipe(tochild) < 0)
+	    || ((options & SHELL_READ) && pipe(fromchild) < 0)) {
+	MSG_PUTS(_("\nCannot create pipes\n"));
+	close_pipes(tochild, fromchild);
+	return -1;
+    }
+
     pid = rfork(RFPROC|RFFDG|RFENVG|RFNOTEG);
-    if(pid < 0)
+    if(pid < 0) {
+	close_pipes(tochild, fromchild);
 	return -1;
+    }
     if(pid == 0){
+	if (options & SHELL_WRITE) {
+	    dup2(tochild[0], 0);
+	    close(tochild[0]);
+	    close(tochild[1]);
+	}
+	if (options & SHELL_READ) {
+	    dup2(fromchild[1], 1);
+	    close(fromchild[0]);
+	    close(fromchild[1]);
+	}
 	if (cmd) 
 	    execl("/bin/rc", "rc", "-c", cmd, NULL);
 	 else 
@@ -1216,6 +1360,58 @@ mch_call_shell(char_u *cmd, int options)
 	
 	_exit(122);
     }
+
+    /* A command that doesn't read all its input must not kill Vim. */
+    savepipe = signal(SIGPIPE, SIG_IGN);
+    if (options & SHELL_WRITE) {
+	close(tochild[0]);
+	tochild[0] = -1;
+	if (options & SHELL_READ) {
+	    /* The writing process reads the lines from its copy of the
+	     * memfile, while this one appends lines.  Write all blocks to the
+	     * swap file first, so that it never has to write, and give it its
+	     * own file offset for reading. */
+	    mfp = curbuf->b_ml.ml_mfp;
+	    if (mfp != NULL && mfp->mf_fd >= 0)
+		ml_preserve(curbuf, FALSE);
+	    wpid = rfork(RFPROC|RFFDG);
+	    if (wpid == 0) {
+		close(fromchild[0]);
+		close(fromchild[1]);
+		if (mfp != NULL && mfp->mf_fd >= 0) {
+		    fd = open((char *)mfp->mf_fname, O_RDONLY);
+		    if (fd >= 0) {
+			dup2(fd, mfp->mf_fd);
+			close(fd);
+		    }
+		}
+		shell_write_lines(tochild[1]);
+		_exit(0);
+	    }
+	    if (wpid < 0) {
+		/* Without a writer the command would get no input and its
+		 * empty output would replace the lines. */
+		MSG_PUTS(_("\nCannot fork\n"));
+		close_pipes(tochild, fromchild);
+		kill(pid, SIGKILL);
+		waitpid(pid, NULL, 0);
+		signal(SIGPIPE, savepipe);
+		return -1;
+	    }
+	} else {
+	    shell_write_lines(tochild[1]);
+	}
+	close(tochild[1]);
+    }
+    if (options & SHELL_READ) {
+	close(fromchild[1]);
+	shell_read_lines(fromchild[0]);
+	close(fromchild[0]);
+    }
+    signal(SIGPIPE, savepipe);
+
+    if (wpid > 0)
+	waitpid(wpid, NULL, 0);
     waitpid(pid, &status, 0);
     return status;
 }
@@ -20,6 +20,7 @@ int vim_isIDc __ARGS((int c));
 int vim_iswordc __ARGS((int c));
 int vim_iswordp __ARGS((char_u *p));
 int vim_iswordc_buf __ARGS((char_u *p, buf_T *buf));
+int vim_wordlen_buf __ARGS((char_u *p, buf_T *buf));
 int vim_isfilec __ARGS((int c));
 int vim_isprintc __ARGS((int c));
 int vim_isprintc_strict __ARGS((int c));
@@ -27,6 +28,11 @@ int lbr_chartabsize __ARGS((unsigned char *s, colnr_T col));
 int lbr_chartabsize_adv __ARGS((char_u **s, colnr_T col));
 int win_lbr_chartabsize __ARGS((win_T *wp, char_u *s, colnr_T col, int *headp));
 int in_win_border __ARGS((win_T *wp, colnr_T vcol));
+colnr_T vcol_checkpoint __ARGS((win_T *wp, linenr_T lnum, char_u *line, colnr_T col, colnr_T vcol, colnr_T *vcolp));
+void vcol_cache_changed __ARGS((linenr_T lnum, colnr_T col, linenr_T lnume, long xtra, int tick));
+void vcol_cache_buf_clear __ARGS((buf_T *buf));
+void vcol_cache_clear __ARGS((void));
+void vcol_cache_free __ARGS((void));
 void getvcol __ARGS((win_T *wp, pos_T *pos, colnr_T *start, colnr_T *cursor, colnr_T *end));
 colnr_T getvcol_nolist __ARGS((pos_T *posp));
 void getvvcol __ARGS((win_T *wp, pos_T *pos, colnr_T *start, colnr_T *cursor, colnr_T *end));
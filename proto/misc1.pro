@@ -12,6 +12,9 @@ int plines_win __ARGS((win_T *wp, linenr_T lnum, int winheight));
 int plines_nofill __ARGS((linenr_T lnum));
 int plines_win_nofill __ARGS((win_T *wp, linenr_T lnum, int winheight));
 int plines_win_nofold __ARGS((win_T *wp, linenr_T lnum));
+void plines_cache_changed __ARGS((win_T *wp, linenr_T lnum, linenr_T lnume, long xtra, int tick));
+void plines_cache_buf_clear __ARGS((buf_T *buf));
+void plines_cache_clear_all __ARGS((void));
 int plines_win_col __ARGS((win_T *wp, linenr_T lnum, long column));
 int plines_m_win __ARGS((win_T *wp, linenr_T first, linenr_T last));
 void ins_bytes __ARGS((char_u *p));
@@ -9,8 +9,12 @@ char_u *last_search_pat __ARGS((void));
 void reset_search_dir __ARGS((void));
 void set_last_search_pat __ARGS((char_u *s, int idx, int magic, int setlast));
 void last_pat_prog __ARGS((regmmatch_T *regmatch));
-int searchit __ARGS((win_T *win, buf_T *buf, pos_T *pos, int dir, char_u *pat, long count, int options, int pat_use, linenr_T stop_lnum));
-int do_search __ARGS((oparg_T *oap, int dirc, char_u *pat, long count, int options));
+void search_idx_free __ARGS((buf_T *buf));
+int search_idx_line __ARGS((buf_T *buf, linenr_T lnum, regbudget_T *budget));
+void search_idx_changed __ARGS((buf_T *buf, linenr_T lnum, linenr_T lnume, long xtra));
+int search_idx_idle __ARGS((void));
+int searchit __ARGS((win_T *win, buf_T *buf, pos_T *pos, int dir, char_u *pat, long count, int options, int pat_use, linenr_T stop_lnum, regbudget_T *budget));
+int do_search __ARGS((oparg_T *oap, int dirc, char_u *pat, long count, int options, regbudget_T *budget));
 int search_for_exact_line __ARGS((buf_T *buf, pos_T *pos, int dir, char_u *pat));
 int searchc __ARGS((cmdarg_T *cap, int t_cmd));
 pos_T *findmatch __ARGS((oparg_T *oap, int initc));
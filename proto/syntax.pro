@@ -1,16 +1,21 @@
 /* syntax.c */
 void syntax_start __ARGS((win_T *wp, linenr_T lnum));
+void syntax_start_draw __ARGS((win_T *wp, linenr_T lnum));
+int syn_idle __ARGS((void));
 void syn_stack_free_all __ARGS((buf_T *buf));
 void syn_stack_apply_changes __ARGS((buf_T *buf));
 void syntax_end_parsing __ARGS((linenr_T lnum));
 int syntax_check_changed __ARGS((linenr_T lnum));
 int get_syntax_attr __ARGS((colnr_T col, int *can_spell));
+void syn_set_budget __ARGS((regbudget_T *rb));
 void syntax_clear __ARGS((buf_T *buf));
 void ex_syntax __ARGS((exarg_T *eap));
 int syntax_present __ARGS((buf_T *buf));
+void ex_syntime __ARGS((exarg_T *eap));
 void set_context_in_syntax_cmd __ARGS((expand_T *xp, char_u *arg));
 char_u *get_syntax_name __ARGS((expand_T *xp, int idx));
 int syn_get_id __ARGS((win_T *wp, long lnum, colnr_T col, int trans, int *spellp));
+int syn_get_line_ids __ARGS((win_T *wp, linenr_T lnum, int trans, garray_T *gap));
 int syn_get_foldlevel __ARGS((win_T *wp, long lnum));
 void init_highlight __ARGS((int both, int reset));
 int load_colors __ARGS((char_u *name));
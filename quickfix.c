@@ -1803,7 +1803,8 @@ qf_jump(qi, dir, errornr, forceit)
 	    /* Move the cursor to the first line in the buffer */
 	    save_cursor = curwin->w_cursor;
 	    curwin->w_cursor.lnum = 0;
-	    if (!do_search(NULL, '/', qf_ptr->qf_pattern, (long)1, SEARCH_KEEP))
+	    if (!do_search(NULL, '/', qf_ptr->qf_pattern, (long)1,
+							   SEARCH_KEEP, NULL))
 		curwin->w_cursor = save_cursor;
 	}
 
@@ -3133,9 +3134,13 @@ ex_vimgrep(eap)
 	    for (lnum = 1; lnum <= buf->b_ml.ml_line_count && tomatch > 0;
 								       ++lnum)
 	    {
+		/* Skip over the lines without a match in one go. */
+		lnum = vim_regexec_lines(&regmatch, curwin, buf, lnum,
+					buf->b_ml.ml_line_count, NULL, NULL);
+		if (lnum == 0)
+		    break;
 		col = 0;
-		while (vim_regexec_multi(&regmatch, curwin, buf, lnum,
-								     col) > 0)
+		do
 		{
 		    if (qf_add_entry(qi, &prevp,
 				NULL,       /* dir */
@@ -3166,6 +3171,8 @@ ex_vimgrep(eap)
 		    if (col > STRLEN(ml_get_buf(buf, lnum, FALSE)))
 			break;
 		}
+		while (vim_regexec_multi(&regmatch, curwin, buf, lnum,
+							       col, NULL) > 0);
 		line_breakcheck();
 		if (got_int)
 		    break;
@@ -333,8 +333,6 @@ toggle_Magic(x)
 #define MAX_LIMIT	(32767L << 16L)
 
 static int re_multi_type __ARGS((int));
-static int cstrncmp __ARGS((char_u *s1, char_u *s2, int *n));
-static char_u *cstrchr __ARGS((char_u *, int));
 
 #ifdef DEBUG
 static void	regdump __ARGS((char_u *, regprog_T *));
@@ -576,6 +574,7 @@ init_class_tab()
 #define RF_HASNL    4	/* can match a NL */
 #define RF_ICOMBINE 8	/* ignore combining characters */
 #define RF_LOOKBH   16	/* uses "\@<=" or "\@<!" */
+#define RF_STATE    32	/* uses the line number, cursor, marks, etc. */
 
 /*
  * Global work variables for vim_regcomp().
@@ -593,9 +592,6 @@ static char_u	*regcode;	/* Code-emit pointer, or JUST_CALC_SIZE */
 static long	regsize;	/* Code size. */
 static char_u	had_endbrace[NSUBEXP];	/* flags, TRUE if end of () found */
 static unsigned	regflags;	/* RF_ flags for prog */
-static long	brace_min[10];	/* Minimums for complex brace repeats */
-static long	brace_max[10];	/* Maximums for complex brace repeats */
-static int	brace_count[10]; /* Current counts for complex brace repeats */
 #if defined(FEAT_SYN_HL) || defined(PROTO)
 static int	had_eol;	/* TRUE when EOL found by vim_regcomp() */
 #endif
@@ -668,7 +664,6 @@ static char_u	*regnode __ARGS((int));
 #ifdef FEAT_MBYTE
 static int	use_multibytecode __ARGS((int c));
 #endif
-static int	prog_magic_wrong __ARGS((void));
 static char_u	*regnext __ARGS((char_u *));
 static void	regc __ARGS((int b));
 #ifdef FEAT_MBYTE
@@ -704,6 +699,18 @@ re_lookbehind(prog)
     return (prog->regflags & RF_LOOKBH);
 }
 
+/*
+ * Return TRUE if what compiled regular expression "prog" matches in a line
+ * depends on more than the text of that line: the line number, the position
+ * in the buffer, the cursor, the Visual area, a mark or the window.
+ */
+    int
+re_stateful(prog)
+    regprog_T *prog;
+{
+    return (prog->regflags & RF_STATE);
+}
+
 /*
  * Check for an equivalence class name "[=a=]".  "pp" points to the '['.
  * Returns a character representing the class. Zero means that no item was
@@ -1842,18 +1849,22 @@ regatom(flagp)
 		 * pattern -- regardless of whether or not it makes sense. */
 		case '^':
 		    ret = regnode(RE_BOF);
+		    regflags |= RF_STATE;
 		    break;
 
 		case '$':
 		    ret = regnode(RE_EOF);
+		    regflags |= RF_STATE;
 		    break;
 
 		case '#':
 		    ret = regnode(CURSOR);
+		    regflags |= RF_STATE;
 		    break;
 
 		case 'V':
 		    ret = regnode(RE_VISUAL);
+		    regflags |= RF_STATE;
 		    break;
 
 		/* \%[abc]: Emit as a list of branches, all ending at the last
@@ -1972,6 +1983,7 @@ regatom(flagp)
 				  /* "\%'m", "\%<'m" and "\%>'m": Mark */
 				  c = getchr();
 				  ret = regnode(RE_MARK);
+				  regflags |= RF_STATE;
 				  if (ret == JUST_CALC_SIZE)
 				      regsize += 2;
 				  else
@@ -1989,6 +2001,8 @@ regatom(flagp)
 				      ret = regnode(RE_COL);
 				  else
 				      ret = regnode(RE_VCOL);
+				  if (c != 'c')
+				      regflags |= RF_STATE;
 				  if (ret == JUST_CALC_SIZE)
 				      regsize += 5;
 				  else
@@ -3005,22 +3019,6 @@ read_limits(minval, maxval)
  * vim_regexec and friends
  */
 
-/*
- * Global work variables for vim_regexec().
- */
-
-/* The current match-position is remembered with these variables: */
-static linenr_T	reglnum;	/* line number, relative to first line */
-static char_u	*regline;	/* start of current line */
-static char_u	*reginput;	/* current input, points into "regline" */
-
-static int	need_clear_subexpr;	/* subexpressions still need to be
-					 * cleared */
-#ifdef FEAT_SYN_HL
-static int	need_clear_zsubexpr = FALSE;	/* extmatch subexpressions
-						 * still need to be cleared */
-#endif
-
 /*
  * Structure used to save the current input state, when it needs to be
  * restored after trying a match.  Used by reg_save() and reg_restore().
@@ -3030,8 +3028,8 @@ typedef struct
 {
     union
     {
-	char_u	*ptr;	/* reginput pointer, for single-line regexp */
-	lpos_T	pos;	/* reginput pos, for multi-line regexp */
+	char_u	*ptr;	/* rex->input pointer, for single-line regexp */
+	lpos_T	pos;	/* rex->input pos, for multi-line regexp */
     } rs_u;
     int		rs_len;
 } regsave_T;
@@ -3046,23 +3044,135 @@ typedef struct
     } se_u;
 } save_se_T;
 
-static char_u	*reg_getline __ARGS((linenr_T lnum));
-static long	vim_regexec_both __ARGS((char_u *line, colnr_T col));
-static long	regtry __ARGS((regprog_T *prog, colnr_T col));
-static void	cleanup_subexpr __ARGS((void));
+/*
+ * All the state of one vim_regexec() call.  It lives on the stack of the
+ * vim_regexec*() entry point and is passed down to every matcher function,
+ * thus nothing is shared between calls.  A pattern may be executed again
+ * while a match is in progress, e.g. from a "\=" expression in ":s" or from
+ * an autocommand, without saving and restoring anything.
+ *
+ * Which fields are set depends on whether a single-line or multi-line match
+ * is done:
+ *			single-line		multi-line
+ * reg_match		&regmatch_T		NULL
+ * reg_mmatch		NULL			&regmmatch_T
+ * reg_startp		reg_match->startp	<invalid>
+ * reg_endp		reg_match->endp		<invalid>
+ * reg_startpos		<invalid>		reg_mmatch->startpos
+ * reg_endpos		<invalid>		reg_mmatch->endpos
+ * reg_win		NULL			window in which to search
+ * reg_buf		<invalid>		buffer in which to search
+ * reg_firstlnum	<invalid>		first line in which to search
+ * reg_maxline		0			last line nr
+ * reg_line_lbr		FALSE or TRUE		FALSE
+ */
+typedef struct regexec_S
+{
+    /* The current match-position. */
+    linenr_T	lnum;		/* line number, relative to first line */
+    char_u	*line;		/* start of current line */
+    char_u	*input;		/* current input, points into "line" */
+
+    int		need_clear_subexpr;	/* subexpressions still need to be
+					 * cleared */
 #ifdef FEAT_SYN_HL
-static void	cleanup_zsubexpr __ARGS((void));
+    int		need_clear_zsubexpr;	/* extmatch subexpressions still
+					 * need to be cleared */
 #endif
-static void	reg_nextline __ARGS((void));
-static void	reg_save __ARGS((regsave_T *save, garray_T *gap));
-static void	reg_restore __ARGS((regsave_T *save, garray_T *gap));
-static int	reg_save_equal __ARGS((regsave_T *save));
-static void	save_se_multi __ARGS((save_se_T *savep, lpos_T *posp));
-static void	save_se_one __ARGS((save_se_T *savep, char_u **pp));
+
+    /* Internal copy of 'ignorecase'.  Normally it gets the value of "rm_ic"
+     * or "rmm_ic", but when the pattern contains '\c' or '\C' the value is
+     * overruled. */
+    int		reg_ic;
+#ifdef FEAT_MBYTE
+    /* Similar to reg_ic, but only for 'combining' characters.  Set with \Z
+     * flag in the regexp.  Defaults to false, always. */
+    int		reg_icombine;
+#endif
+    /* Copy of "rmm_maxcol": maximum column to search for a match.  Zero when
+     * there is no maximum. */
+    colnr_T	reg_maxcol;
+
+    /* Sometimes need to save a copy of a line.  Since alloc()/free() is very
+     * slow, we keep one allocated piece of memory and only re-allocate it
+     * when it's too small.  It's freed in vim_regexec_both() when finished. */
+    char_u	*reg_tofree;
+    unsigned	reg_tofreelen;
+
+    regmatch_T	*reg_match;
+    regmmatch_T	*reg_mmatch;
+    char_u	**reg_startp;
+    char_u	**reg_endp;
+    lpos_T	*reg_startpos;
+    lpos_T	*reg_endpos;
+    win_T	*reg_win;
+    buf_T	*reg_buf;
+    linenr_T	reg_firstlnum;
+    linenr_T	reg_maxline;
+    int		reg_line_lbr;	/* "\n" in string is line break */
+
+    /* regstack and backpos are used by regmatch().  They are kept over the
+     * whole call to avoid invoking malloc() and free() often. */
+    garray_T	regstack;	/* stack with regitem_T items, sometimes
+				   preceded by regstar_T or regbehind_T. */
+    garray_T	backpos;	/* table with backpos_T for BACK */
+
+    regsave_T	behind_pos;
+
+    /* The arguments from BRACE_LIMITS are stored here.  They are actually
+     * local to regmatch(), but they are here to reduce the amount of stack
+     * space used (it can be called recursively many times). */
+    long	bl_minval;
+    long	bl_maxval;
+
+    long	brace_min[10];	/* Minimums for complex brace repeats */
+    long	brace_max[10];	/* Maximums for complex brace repeats */
+    int		brace_count[10]; /* Current counts for complex brace repeats */
+
+    /* Limit set by the caller, NULL when there is none. */
+    regbudget_T	*reg_budget;
+
+#ifdef FEAT_SYN_HL
+    /* Must be last, reg_exec_init() doesn't clear these. */
+    char_u	*reg_startzp[NSUBEXP];	/* Workspace to mark beginning */
+    char_u	*reg_endzp[NSUBEXP];	/*   and end of \z(...\) matches */
+    lpos_T	reg_startzpos[NSUBEXP];	/* idem, beginning pos */
+    lpos_T	reg_endzpos[NSUBEXP];	/* idem, end pos */
+#endif
+} regexec_T;
+
+/* TRUE when the budget of "rex" was used up. */
+#define REG_TIMED_OUT(rex) \
+	((rex)->reg_budget != NULL && (rex)->reg_budget->rb_timed_out)
+
+static void	reg_exec_init __ARGS((regexec_T *rex));
+static void	reg_budget_step __ARGS((regbudget_T *rb));
+static char_u	*reg_getline __ARGS((regexec_T *rex, linenr_T lnum));
+static void	reg_exec_stacks __ARGS((regexec_T *rex, int init));
+static long	vim_regexec_both __ARGS((regexec_T *rex, char_u *line,
+								colnr_T col));
+static long	regexec_line __ARGS((regexec_T *rex, char_u *line,
+								colnr_T col));
+static long	regtry __ARGS((regexec_T *rex, regprog_T *prog, colnr_T col));
+static void	cleanup_subexpr __ARGS((regexec_T *rex));
+#ifdef FEAT_SYN_HL
+static void	cleanup_zsubexpr __ARGS((regexec_T *rex));
+#endif
+static void	reg_nextline __ARGS((regexec_T *rex));
+static void	reg_save __ARGS((regexec_T *rex, regsave_T *save,
+							       garray_T *gap));
+static void	reg_restore __ARGS((regexec_T *rex, regsave_T *save,
+							       garray_T *gap));
+static int	reg_save_equal __ARGS((regexec_T *rex, regsave_T *save));
+static void	save_se_multi __ARGS((regexec_T *rex, save_se_T *savep,
+								lpos_T *posp));
+static void	save_se_one __ARGS((regexec_T *rex, save_se_T *savep,
+								char_u **pp));
 
 /* Save the sub-expressions before attempting a match. */
 #define save_se(savep, posp, pp) \
-    REG_MULTI ? save_se_multi((savep), (posp)) : save_se_one((savep), (pp))
+    REG_MULTI ? save_se_multi(rex, (savep), (posp)) \
+	      : save_se_one(rex, (savep), (pp))
 
 /* After a failed match restore the sub-expressions. */
 #define restore_se(savep, posp, pp) { \
@@ -3072,71 +3182,17 @@ static void	save_se_one __ARGS((save_se_T *savep, char_u **pp));
 	*(pp) = (savep)->se_u.ptr; }
 
 static int	re_num_cmp __ARGS((long_u val, char_u *scan));
-static int	regmatch __ARGS((char_u *prog));
-static int	regrepeat __ARGS((char_u *p, long maxcount));
+static int	regmatch __ARGS((regexec_T *rex, char_u *prog));
+static int	regrepeat __ARGS((regexec_T *rex, char_u *p, long maxcount));
+static int	prog_magic_wrong __ARGS((regexec_T *rex));
+static int	cstrncmp __ARGS((regexec_T *rex, char_u *s1, char_u *s2,
+								      int *n));
+static char_u	*cstrchr __ARGS((regexec_T *rex, char_u *, int));
 
 #ifdef DEBUG
 int		regnarrate = 0;
 #endif
 
-/*
- * Internal copy of 'ignorecase'.  It is set at each call to vim_regexec().
- * Normally it gets the value of "rm_ic" or "rmm_ic", but when the pattern
- * contains '\c' or '\C' the value is overruled.
- */
-static int	ireg_ic;
-
-#ifdef FEAT_MBYTE
-/*
- * Similar to ireg_ic, but only for 'combining' characters.  Set with \Z flag
- * in the regexp.  Defaults to false, always.
- */
-static int	ireg_icombine;
-#endif
-
-/*
- * Copy of "rmm_maxcol": maximum column to search for a match.  Zero when
- * there is no maximum.
- */
-static colnr_T	ireg_maxcol;
-
-/*
- * Sometimes need to save a copy of a line.  Since alloc()/free() is very
- * slow, we keep one allocated piece of memory and only re-allocate it when
- * it's too small.  It's freed in vim_regexec_both() when finished.
- */
-static char_u	*reg_tofree;
-static unsigned	reg_tofreelen;
-
-/*
- * These variables are set when executing a regexp to speed up the execution.
- * Which ones are set depends on whether a single-line or multi-line match is
- * done:
- *			single-line		multi-line
- * reg_match		&regmatch_T		NULL
- * reg_mmatch		NULL			&regmmatch_T
- * reg_startp		reg_match->startp	<invalid>
- * reg_endp		reg_match->endp		<invalid>
- * reg_startpos		<invalid>		reg_mmatch->startpos
- * reg_endpos		<invalid>		reg_mmatch->endpos
- * reg_win		NULL			window in which to search
- * reg_buf		<invalid>		buffer in which to search
- * reg_firstlnum	<invalid>		first line in which to search
- * reg_maxline		0			last line nr
- * reg_line_lbr		FALSE or TRUE		FALSE
- */
-static regmatch_T	*reg_match;
-static regmmatch_T	*reg_mmatch;
-static char_u		**reg_startp = NULL;
-static char_u		**reg_endp = NULL;
-static lpos_T		*reg_startpos = NULL;
-static lpos_T		*reg_endpos = NULL;
-static win_T		*reg_win;
-static buf_T		*reg_buf;
-static linenr_T		reg_firstlnum;
-static linenr_T		reg_maxline;
-static int		reg_line_lbr;	    /* "\n" in string is line break */
-
 /* Values for rs_state in regitem_T. */
 typedef enum regstate_E
 {
@@ -3172,12 +3228,13 @@ typedef struct regitem_S
     {
 	save_se_T  sesave;
 	regsave_T  regsave;
-    } rs_un;			/* room for saving reginput */
+    } rs_un;			/* room for saving rex->input */
     short	rs_no;		/* submatch nr */
 } regitem_T;
 
-static regitem_T *regstack_push __ARGS((regstate_T state, char_u *scan));
-static void regstack_pop __ARGS((char_u **scan));
+static regitem_T *regstack_push __ARGS((regexec_T *rex, regstate_T state,
+								char_u *scan));
+static void regstack_pop __ARGS((regexec_T *rex, char_u **scan));
 
 /* used for BEHIND and NOBEHIND matching */
 typedef struct regbehind_S
@@ -3204,42 +3261,90 @@ typedef struct backpos_S
     regsave_T	bp_pos;		/* last input position */
 } backpos_T;
 
-/*
- * regstack and backpos are used by regmatch().  They are kept over calls to
- * avoid invoking malloc() and free() often.
- */
-static garray_T	regstack;	/* stack with regitem_T items, sometimes
-				   preceded by regstar_T or regbehind_T. */
-static garray_T	backpos;	/* table with backpos_T for BACK */
-
 /*
  * Get pointer to the line "lnum", which is relative to "reg_firstlnum".
  */
     static char_u *
-reg_getline(lnum)
+reg_getline(rex, lnum)
+    regexec_T	*rex;
     linenr_T	lnum;
 {
     /* when looking behind for a match/no-match lnum is negative.  But we
      * can't go before line 1 */
-    if (reg_firstlnum + lnum < 1)
+    if (rex->reg_firstlnum + lnum < 1)
 	return NULL;
-    if (lnum > reg_maxline)
+    if (lnum > rex->reg_maxline)
 	/* Must have matched the "\n" in the last line. */
 	return (char_u *)"";
-    return ml_get_buf(reg_buf, reg_firstlnum + lnum, FALSE);
+    return ml_get_buf(rex->reg_buf, rex->reg_firstlnum + lnum, FALSE);
 }
 
-static regsave_T behind_pos;
-
+/*
+ * Initialize an execution context: everything empty, single-line, no
+ * maximum column.
+ */
+    static void
+reg_exec_init(rex)
+    regexec_T	*rex;
+{
 #ifdef FEAT_SYN_HL
-static char_u	*reg_startzp[NSUBEXP];	/* Workspace to mark beginning */
-static char_u	*reg_endzp[NSUBEXP];	/*   and end of \z(...\) matches */
-static lpos_T	reg_startzpos[NSUBEXP];	/* idem, beginning pos */
-static lpos_T	reg_endzpos[NSUBEXP];	/* idem, end pos */
+    /* This is done for every match and substitute, skip the \z() workspace,
+     * which is cleared by cleanup_zsubexpr() before it is used. */
+    vim_memset(rex, 0, (size_t)((char_u *)rex->reg_startzp - (char_u *)rex));
+#else
+    vim_memset(rex, 0, sizeof(regexec_T));
+#endif
+}
+
+#ifndef FEAT_RELTIME
+/* Without a timer a step is assumed to take this fraction of a msec. */
+# define REG_STEPS_PER_MSEC	5000L
+#endif
+
+/*
+ * Initialize "rb" for executing regexps for at most about "msec"
+ * milliseconds, zero or less for no limit.  Pass it to vim_regexec_multi(),
+ * searchit(), etc.  When "rb->rb_timed_out" is set after a call, the search
+ * was stopped early and did not look at all the text.
+ */
+    void
+regbudget_init(rb, msec)
+    regbudget_T	*rb;
+    long	msec;
+{
+    rb->rb_steps = 0;
+    rb->rb_timed_out = FALSE;
+#ifdef FEAT_RELTIME
+    rb->rb_maxsteps = 0;
+    profile_setlimit(msec, &rb->rb_deadline);
+#else
+    rb->rb_maxsteps = msec > 0 ? msec * REG_STEPS_PER_MSEC : 0;
+#endif
+}
+
+/*
+ * Count one step of regexp execution for budget "rb": an iteration of
+ * regmatch() or trying a line.  Sets rb_timed_out when the budget is used up.
+ */
+    static void
+reg_budget_step(rb)
+    regbudget_T	*rb;
+{
+    if (rb->rb_timed_out)
+	return;
+    ++rb->rb_steps;
+    if (rb->rb_maxsteps > 0 && rb->rb_steps >= rb->rb_maxsteps)
+	rb->rb_timed_out = TRUE;
+#ifdef FEAT_RELTIME
+    /* Looking at the time is relatively slow, don't do it every step. */
+    else if ((rb->rb_steps & 0xff) == 0
+				    && profile_passed_limit(&rb->rb_deadline))
+	rb->rb_timed_out = TRUE;
 #endif
+}
 
 /* TRUE if using multi-line regexp. */
-#define REG_MULTI	(reg_match == NULL)
+#define REG_MULTI	(rex->reg_match == NULL)
 
 /*
  * Match a regexp against a string.
@@ -3254,17 +3359,12 @@ vim_regexec(rmp, line, col)
     char_u	*line;	/* string to match against */
     colnr_T	col;	/* column to start looking for match */
 {
-    reg_match = rmp;
-    reg_mmatch = NULL;
-    reg_maxline = 0;
-    reg_line_lbr = FALSE;
-    reg_win = NULL;
-    ireg_ic = rmp->rm_ic;
-#ifdef FEAT_MBYTE
-    ireg_icombine = FALSE;
-#endif
-    ireg_maxcol = 0;
-    return (vim_regexec_both(line, col) != 0);
+    regexec_T	rex;
+
+    reg_exec_init(&rex);
+    rex.reg_match = rmp;
+    rex.reg_ic = rmp->rm_ic;
+    return (vim_regexec_both(&rex, line, col) != 0);
 }
 
 #if defined(FEAT_MODIFY_FNAME) || defined(FEAT_EVAL) \
@@ -3278,17 +3378,13 @@ vim_regexec_nl(rmp, line, col)
     char_u	*line;	/* string to match against */
     colnr_T	col;	/* column to start looking for match */
 {
-    reg_match = rmp;
-    reg_mmatch = NULL;
-    reg_maxline = 0;
-    reg_line_lbr = TRUE;
-    reg_win = NULL;
-    ireg_ic = rmp->rm_ic;
-#ifdef FEAT_MBYTE
-    ireg_icombine = FALSE;
-#endif
-    ireg_maxcol = 0;
-    return (vim_regexec_both(line, col) != 0);
+    regexec_T	rex;
+
+    reg_exec_init(&rex);
+    rex.reg_match = rmp;
+    rex.reg_line_lbr = TRUE;
+    rex.reg_ic = rmp->rm_ic;
+    return (vim_regexec_both(&rex, line, col) != 0);
 }
 #endif
 
@@ -3296,77 +3392,195 @@ vim_regexec_nl(rmp, line, col)
  * Match a regexp against multiple lines.
  * "rmp->regprog" is a compiled regexp as returned by vim_regcomp().
  * Uses curbuf for line count and 'iskeyword'.
+ * When "budget" is not NULL matching stops when it is used up; then
+ * "budget->rb_timed_out" is set and zero is returned.
  *
  * Return zero if there is no match.  Return number of lines contained in the
  * match otherwise.
  */
     long
-vim_regexec_multi(rmp, win, buf, lnum, col)
+vim_regexec_multi(rmp, win, buf, lnum, col, budget)
     regmmatch_T	*rmp;
     win_T	*win;		/* window in which to search or NULL */
     buf_T	*buf;		/* buffer in which to search */
     linenr_T	lnum;		/* nr of line to start looking for match */
     colnr_T	col;		/* column to start looking for match */
+    regbudget_T	*budget;	/* limit for matching or NULL */
 {
+    regexec_T	rex;
     long	r;
     buf_T	*save_curbuf = curbuf;
 
-    reg_match = NULL;
-    reg_mmatch = rmp;
-    reg_buf = buf;
-    reg_win = win;
-    reg_firstlnum = lnum;
-    reg_maxline = reg_buf->b_ml.ml_line_count - lnum;
-    reg_line_lbr = FALSE;
-    ireg_ic = rmp->rmm_ic;
-#ifdef FEAT_MBYTE
-    ireg_icombine = FALSE;
-#endif
-    ireg_maxcol = rmp->rmm_maxcol;
+    if (budget != NULL)
+    {
+	reg_budget_step(budget);
+	if (budget->rb_timed_out)
+	    return 0;
+    }
+
+    reg_exec_init(&rex);
+    rex.reg_budget = budget;
+    rex.reg_mmatch = rmp;
+    rex.reg_buf = buf;
+    rex.reg_win = win;
+    rex.reg_firstlnum = lnum;
+    rex.reg_maxline = buf->b_ml.ml_line_count - lnum;
+    rex.reg_ic = rmp->rmm_ic;
+    rex.reg_maxcol = rmp->rmm_maxcol;
 
     /* Need to switch to buffer "buf" to make vim_iswordc() work. */
     curbuf = buf;
-    r = vim_regexec_both(NULL, col);
+    r = vim_regexec_both(&rex, NULL, col);
     curbuf = save_curbuf;
 
     return r;
 }
 
+/*
+ * Like vim_regexec_multi(), but try the lines "lnum" to "lnum_end" one after
+ * another (going backwards when "lnum_end" is before "lnum") and stop at the
+ * first line where there is a match.  The context and its stacks are set up
+ * only once for the whole range, which makes skipping over many lines without
+ * a match a lot cheaper than calling vim_regexec_multi() for each line.
+ * Stops early when interrupted, when an error message was given or when
+ * "budget" is used up.
+ *
+ * Return the number of the line with the match and store the number of lines
+ * contained in the match in "*nmatched" (when not NULL).  Return zero when
+ * there is no match.
+ */
+    linenr_T
+vim_regexec_lines(rmp, win, buf, lnum, lnum_end, nmatched, budget)
+    regmmatch_T	*rmp;
+    win_T	*win;		/* window in which to search or NULL */
+    buf_T	*buf;		/* buffer in which to search */
+    linenr_T	lnum;		/* first line to try */
+    linenr_T	lnum_end;	/* last line to try */
+    long	*nmatched;
+    regbudget_T	*budget;	/* limit for matching or NULL */
+{
+    regexec_T	rex;
+    long	r = 0;
+    linenr_T	found = 0;
+    int		dir = lnum_end < lnum ? -1 : 1;
+    int		save_called_emsg = called_emsg;
+    buf_T	*save_curbuf = curbuf;
+
+    reg_exec_init(&rex);
+    rex.reg_mmatch = rmp;
+    rex.reg_buf = buf;
+    rex.reg_win = win;
+    rex.reg_ic = rmp->rmm_ic;
+    rex.reg_maxcol = rmp->rmm_maxcol;
+    rex.reg_budget = budget;
+    reg_exec_stacks(&rex, TRUE);
+
+    /* Need to switch to buffer "buf" to make vim_iswordc() work. */
+    curbuf = buf;
+    called_emsg = FALSE;
+    for (;;)
+    {
+	if (budget != NULL)
+	{
+	    reg_budget_step(budget);
+	    if (budget->rb_timed_out)
+		break;
+	}
+	rex.reg_firstlnum = lnum;
+	rex.reg_maxline = buf->b_ml.ml_line_count - lnum;
+	r = regexec_line(&rex, NULL, (colnr_T)0);
+	if (r > 0)
+	{
+	    found = lnum;
+	    break;
+	}
+	if (lnum == lnum_end || called_emsg || REG_TIMED_OUT(&rex))
+	    break;
+	lnum += dir;
+	line_breakcheck();
+	if (got_int)
+	    break;
+    }
+    curbuf = save_curbuf;
+    called_emsg |= save_called_emsg;
+
+    reg_exec_stacks(&rex, FALSE);
+    if (nmatched != NULL)
+	*nmatched = r;
+    return found;
+}
+
+/*
+ * Init the regstack and backpos table of "rex" empty when "init" is TRUE,
+ * free them and the line copy when "init" is FALSE.
+ */
+    static void
+reg_exec_stacks(rex, init)
+    regexec_T	*rex;
+    int		init;
+{
+    if (init)
+    {
+	/* Use an item size of 1 byte for the regstack, since we push
+	 * different things onto it.  Use a large grow size to avoid
+	 * reallocating it too often. */
+	ga_init2(&rex->regstack, 1, 10000);
+	ga_init2(&rex->backpos, sizeof(backpos_T), 10);
+    }
+    else
+    {
+	vim_free(rex->reg_tofree);
+	rex->reg_tofree = NULL;
+	ga_clear(&rex->regstack);
+	ga_clear(&rex->backpos);
+    }
+}
+
 /*
  * Match a regexp against a string ("line" points to the string) or multiple
  * lines ("line" is NULL, use reg_getline()).
  */
     static long
-vim_regexec_both(line, col)
+vim_regexec_both(rex, line, col)
+    regexec_T	*rex;
     char_u	*line;
     colnr_T	col;		/* column to start looking for match */
 {
-    regprog_T	*prog;
-    char_u	*s;
-    long	retval = 0L;
+    long	retval;
 
-    reg_tofree = NULL;
+    reg_exec_stacks(rex, TRUE);
+    retval = regexec_line(rex, line, col);
+    reg_exec_stacks(rex, FALSE);
 
-    /* Init the regstack empty.  Use an item size of 1 byte, since we push
-     * different things onto it.  Use a large grow size to avoid reallocating
-     * it too often. */
-    ga_init2(&regstack, 1, 10000);
+    return retval;
+}
 
-    /* Init the backpos table empty. */
-    ga_init2(&backpos, sizeof(backpos_T), 10);
+/*
+ * Try matching at "col" and after it in one line, or starting in one line
+ * for a multi-line match.  The stacks of "rex" must have been initialized.
+ */
+    static long
+regexec_line(rex, line, col)
+    regexec_T	*rex;
+    char_u	*line;
+    colnr_T	col;		/* column to start looking for match */
+{
+    regprog_T	*prog;
+    char_u	*s;
+    long	retval = 0L;
 
     if (REG_MULTI)
     {
-	prog = reg_mmatch->regprog;
-	line = reg_getline((linenr_T)0);
-	reg_startpos = reg_mmatch->startpos;
-	reg_endpos = reg_mmatch->endpos;
+	prog = rex->reg_mmatch->regprog;
+	line = reg_getline(rex, (linenr_T)0);
+	rex->reg_startpos = rex->reg_mmatch->startpos;
+	rex->reg_endpos = rex->reg_mmatch->endpos;
     }
     else
     {
-	prog = reg_match->regprog;
-	reg_startp = reg_match->startp;
-	reg_endp = reg_match->endp;
+	prog = rex->reg_match->regprog;
+	rex->reg_startp = rex->reg_match->startp;
+	rex->reg_endp = rex->reg_match->endp;
     }
 
     /* Be paranoid... */
@@ -3377,23 +3591,23 @@ vim_regexec_both(line, col)
     }
 
     /* Check validity of program. */
-    if (prog_magic_wrong())
+    if (prog_magic_wrong(rex))
 	goto theend;
 
     /* If the start column is past the maximum column: no need to try. */
-    if (ireg_maxcol > 0 && col >= ireg_maxcol)
+    if (rex->reg_maxcol > 0 && col >= rex->reg_maxcol)
 	goto theend;
 
-    /* If pattern contains "\c" or "\C": overrule value of ireg_ic */
+    /* If pattern contains "\c" or "\C": overrule value of reg_ic */
     if (prog->regflags & RF_ICASE)
-	ireg_ic = TRUE;
+	rex->reg_ic = TRUE;
     else if (prog->regflags & RF_NOICASE)
-	ireg_ic = FALSE;
+	rex->reg_ic = FALSE;
 
 #ifdef FEAT_MBYTE
-    /* If pattern contains "\Z" overrule value of ireg_icombine */
+    /* If pattern contains "\Z" overrule value of reg_icombine */
     if (prog->regflags & RF_ICOMBINE)
-	ireg_icombine = TRUE;
+	rex->reg_icombine = TRUE;
 #endif
 
     /* If there is a "must appear" string, look for it. */
@@ -3413,30 +3627,30 @@ vim_regexec_both(line, col)
 	 * This is used very often, esp. for ":global".  Use three versions of
 	 * the loop to avoid overhead of conditions.
 	 */
-	if (!ireg_ic
+	if (!rex->reg_ic
 #ifdef FEAT_MBYTE
 		&& !has_mbyte
 #endif
 		)
 	    while ((s = vim_strbyte(s, c)) != NULL)
 	    {
-		if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
+		if (cstrncmp(rex, s, prog->regmust, &prog->regmlen) == 0)
 		    break;		/* Found it. */
 		++s;
 	    }
 #ifdef FEAT_MBYTE
-	else if (!ireg_ic || (!enc_utf8 && mb_char2len(c) > 1))
+	else if (!rex->reg_ic || (!enc_utf8 && mb_char2len(c) > 1))
 	    while ((s = vim_strchr(s, c)) != NULL)
 	    {
-		if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
+		if (cstrncmp(rex, s, prog->regmust, &prog->regmlen) == 0)
 		    break;		/* Found it. */
 		mb_ptr_adv(s);
 	    }
 #endif
 	else
-	    while ((s = cstrchr(s, c)) != NULL)
+	    while ((s = cstrchr(rex, s, c)) != NULL)
 	    {
-		if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
+		if (cstrncmp(rex, s, prog->regmust, &prog->regmlen) == 0)
 		    break;		/* Found it. */
 		mb_ptr_adv(s);
 	    }
@@ -3444,8 +3658,8 @@ vim_regexec_both(line, col)
 	    goto theend;
     }
 
-    regline = line;
-    reglnum = 0;
+    rex->line = line;
+    rex->lnum = 0;
 
     /* Simplest case: Anchored match need be tried only once. */
     if (prog->reganch)
@@ -3454,69 +3668,69 @@ vim_regexec_both(line, col)
 
 #ifdef FEAT_MBYTE
 	if (has_mbyte)
-	    c = (*mb_ptr2char)(regline + col);
+	    c = (*mb_ptr2char)(rex->line + col);
 	else
 #endif
-	    c = regline[col];
+	    c = rex->line[col];
 	if (prog->regstart == NUL
 		|| prog->regstart == c
-		|| (ireg_ic && ((
+		|| (rex->reg_ic && ((
 #ifdef FEAT_MBYTE
 			(enc_utf8 && utf_fold(prog->regstart) == utf_fold(c)))
 			|| (c < 255 && prog->regstart < 255 &&
 #endif
 			    TOLOWER_LOC(prog->regstart) == TOLOWER_LOC(c)))))
-	    retval = regtry(prog, col);
+	    retval = regtry(rex, prog, col);
 	else
 	    retval = 0;
     }
     else
     {
 	/* Messy cases:  unanchored match. */
-	while (!got_int)
+	while (!got_int && !REG_TIMED_OUT(rex))
 	{
 	    if (prog->regstart != NUL)
 	    {
 		/* Skip until the char we know it must start with.
 		 * Used often, do some work to avoid call overhead. */
-		if (!ireg_ic
+		if (!rex->reg_ic
 #ifdef FEAT_MBYTE
 			    && !has_mbyte
 #endif
 			    )
-		    s = vim_strbyte(regline + col, prog->regstart);
+		    s = vim_strbyte(rex->line + col, prog->regstart);
 		else
-		    s = cstrchr(regline + col, prog->regstart);
+		    s = cstrchr(rex, rex->line + col, prog->regstart);
 		if (s == NULL)
 		{
 		    retval = 0;
 		    break;
 		}
-		col = (int)(s - regline);
+		col = (int)(s - rex->line);
 	    }
 
 	    /* Check for maximum column to try. */
-	    if (ireg_maxcol > 0 && col >= ireg_maxcol)
+	    if (rex->reg_maxcol > 0 && col >= rex->reg_maxcol)
 	    {
 		retval = 0;
 		break;
 	    }
 
-	    retval = regtry(prog, col);
+	    retval = regtry(rex, prog, col);
 	    if (retval > 0)
 		break;
 
 	    /* if not currently on the first line, get it again */
-	    if (reglnum != 0)
+	    if (rex->lnum != 0)
 	    {
-		reglnum = 0;
-		regline = reg_getline((linenr_T)0);
+		rex->lnum = 0;
+		rex->line = reg_getline(rex, (linenr_T)0);
 	    }
-	    if (regline[col] == NUL)
+	    if (rex->line[col] == NUL)
 		break;
 #ifdef FEAT_MBYTE
 	    if (has_mbyte)
-		col += (*mb_ptr2len)(regline + col);
+		col += (*mb_ptr2len)(rex->line + col);
 	    else
 #endif
 		++col;
@@ -3524,10 +3738,6 @@ vim_regexec_both(line, col)
     }
 
 theend:
-    vim_free(reg_tofree);
-    ga_clear(&regstack);
-    ga_clear(&backpos);
-
     return retval;
 }
 
@@ -3580,48 +3790,49 @@ unref_extmatch(em)
 #endif
 
 /*
- * regtry - try match of "prog" with at regline["col"].
+ * regtry - try match of "prog" with at rex->line["col"].
  * Returns 0 for failure, number of lines contained in the match otherwise.
  */
     static long
-regtry(prog, col)
+regtry(rex, prog, col)
+    regexec_T	*rex;
     regprog_T	*prog;
     colnr_T	col;
 {
-    reginput = regline + col;
-    need_clear_subexpr = TRUE;
+    rex->input = rex->line + col;
+    rex->need_clear_subexpr = TRUE;
 #ifdef FEAT_SYN_HL
     /* Clear the external match subpointers if necessary. */
     if (prog->reghasz == REX_SET)
-	need_clear_zsubexpr = TRUE;
+	rex->need_clear_zsubexpr = TRUE;
 #endif
 
-    if (regmatch(prog->program + 1) == 0)
+    if (regmatch(rex, prog->program + 1) == 0)
 	return 0;
 
-    cleanup_subexpr();
+    cleanup_subexpr(rex);
     if (REG_MULTI)
     {
-	if (reg_startpos[0].lnum < 0)
+	if (rex->reg_startpos[0].lnum < 0)
 	{
-	    reg_startpos[0].lnum = 0;
-	    reg_startpos[0].col = col;
+	    rex->reg_startpos[0].lnum = 0;
+	    rex->reg_startpos[0].col = col;
 	}
-	if (reg_endpos[0].lnum < 0)
+	if (rex->reg_endpos[0].lnum < 0)
 	{
-	    reg_endpos[0].lnum = reglnum;
-	    reg_endpos[0].col = (int)(reginput - regline);
+	    rex->reg_endpos[0].lnum = rex->lnum;
+	    rex->reg_endpos[0].col = (int)(rex->input - rex->line);
 	}
 	else
 	    /* Use line number of "\ze". */
-	    reglnum = reg_endpos[0].lnum;
+	    rex->lnum = rex->reg_endpos[0].lnum;
     }
     else
     {
-	if (reg_startp[0] == NULL)
-	    reg_startp[0] = regline + col;
-	if (reg_endp[0] == NULL)
-	    reg_endp[0] = reginput;
+	if (rex->reg_startp[0] == NULL)
+	    rex->reg_startp[0] = rex->line + col;
+	if (rex->reg_endp[0] == NULL)
+	    rex->reg_endp[0] = rex->input;
     }
 #ifdef FEAT_SYN_HL
     /* Package any found \z(...\) matches for export. Default is none. */
@@ -3632,58 +3843,54 @@ regtry(prog, col)
     {
 	int		i;
 
-	cleanup_zsubexpr();
+	cleanup_zsubexpr(rex);
 	re_extmatch_out = make_extmatch();
 	for (i = 0; i < NSUBEXP; i++)
 	{
 	    if (REG_MULTI)
 	    {
 		/* Only accept single line matches. */
-		if (reg_startzpos[i].lnum >= 0
-			&& reg_endzpos[i].lnum == reg_startzpos[i].lnum)
-		    re_extmatch_out->matches[i] =
-			vim_strnsave(reg_getline(reg_startzpos[i].lnum)
-						       + reg_startzpos[i].col,
-				   reg_endzpos[i].col - reg_startzpos[i].col);
+		if (rex->reg_startzpos[i].lnum >= 0
+			&& rex->reg_endzpos[i].lnum
+					       == rex->reg_startzpos[i].lnum)
+		    re_extmatch_out->matches[i] = vim_strnsave(
+			    reg_getline(rex, rex->reg_startzpos[i].lnum)
+						  + rex->reg_startzpos[i].col,
+			    rex->reg_endzpos[i].col
+						  - rex->reg_startzpos[i].col);
 	    }
 	    else
 	    {
-		if (reg_startzp[i] != NULL && reg_endzp[i] != NULL)
+		if (rex->reg_startzp[i] != NULL && rex->reg_endzp[i] != NULL)
 		    re_extmatch_out->matches[i] =
-			    vim_strnsave(reg_startzp[i],
-					(int)(reg_endzp[i] - reg_startzp[i]));
+			    vim_strnsave(rex->reg_startzp[i],
+				      (int)(rex->reg_endzp[i]
+						       - rex->reg_startzp[i]));
 	    }
 	}
     }
 #endif
-    return 1 + reglnum;
+    return 1 + rex->lnum;
 }
 
 #ifdef FEAT_MBYTE
-static int reg_prev_class __ARGS((void));
+static int reg_prev_class __ARGS((regexec_T *rex));
 
 /*
  * Get class of previous character.
  */
     static int
-reg_prev_class()
+reg_prev_class(rex)
+    regexec_T	*rex;
 {
-    if (reginput > regline)
-	return mb_get_class(reginput - 1
-				     - (*mb_head_off)(regline, reginput - 1));
+    if (rex->input > rex->line)
+	return mb_get_class(rex->input - 1
+			       - (*mb_head_off)(rex->line, rex->input - 1));
     return -1;
 }
 
 #endif
-#define ADVANCE_REGINPUT() mb_ptr_adv(reginput)
-
-/*
- * The arguments from BRACE_LIMITS are stored here.  They are actually local
- * to regmatch(), but they are here to reduce the amount of stack space used
- * (it can be called recursively many times).
- */
-static long	bl_minval;
-static long	bl_maxval;
+#define ADVANCE_REGINPUT() mb_ptr_adv(rex->input)
 
 /*
  * regmatch - main matching routine
@@ -3695,13 +3902,14 @@ static long	bl_maxval;
  * (that don't need to know whether the rest of the match failed) by a nested
  * loop.
  *
- * Returns TRUE when there is a match.  Leaves reginput and reglnum just after
- * the last matched character.
- * Returns FALSE when there is no match.  Leaves reginput and reglnum in an
- * undefined state!
+ * Returns TRUE when there is a match.  Leaves rex->input and rex->lnum just
+ * after the last matched character.
+ * Returns FALSE when there is no match.  Leaves rex->input and rex->lnum in
+ * an undefined state!
  */
     static int
-regmatch(scan)
+regmatch(rex, scan)
+    regexec_T	*rex;
     char_u	*scan;		/* Current node. */
 {
   char_u	*next;		/* Next node. */
@@ -3718,8 +3926,8 @@ regmatch(scan)
 
   /* Init the regstack and backpos table empty.  They are initialized and
    * freed in vim_regexec_both() to reduce malloc()/free() calls. */
-  regstack.ga_len = 0;
-  backpos.ga_len = 0;
+  rex->regstack.ga_len = 0;
+  rex->backpos.ga_len = 0;
 
   /*
    * Repeat until "regstack" is empty.
@@ -3727,8 +3935,11 @@ regmatch(scan)
   for (;;)
   {
     /* Some patterns my cause a long time to match, even though they are not
-     * illegal.  E.g., "\([a-z]\+\)\+Q".  Allow breaking them with CTRL-C. */
+     * illegal.  E.g., "\([a-z]\+\)\+Q".  Allow breaking them with CTRL-C.
+     * The caller may also have set a limit. */
     fast_breakcheck();
+    if (rex->reg_budget != NULL)
+	reg_budget_step(rex->reg_budget);
 
 #ifdef DEBUG
     if (scan != NULL && regnarrate)
@@ -3744,7 +3955,7 @@ regmatch(scan)
      */
     for (;;)
     {
-	if (got_int || scan == NULL)
+	if (got_int || scan == NULL || REG_TIMED_OUT(rex))
 	{
 	    status = RA_FAIL;
 	    break;
@@ -3777,12 +3988,12 @@ regmatch(scan)
 
 	op = OP(scan);
 	/* Check for character class with NL added. */
-	if (!reg_line_lbr && WITH_NL(op) && REG_MULTI
-				&& *reginput == NUL && reglnum <= reg_maxline)
+	if (!rex->reg_line_lbr && WITH_NL(op) && REG_MULTI
+		      && *rex->input == NUL && rex->lnum <= rex->reg_maxline)
 	{
-	    reg_nextline();
+	    reg_nextline(rex);
 	}
-	else if (reg_line_lbr && WITH_NL(op) && *reginput == '\n')
+	else if (rex->reg_line_lbr && WITH_NL(op) && *rex->input == '\n')
 	{
 	    ADVANCE_REGINPUT();
 	}
@@ -3792,14 +4003,14 @@ regmatch(scan)
 	      op -= ADD_NL;
 #ifdef FEAT_MBYTE
 	  if (has_mbyte)
-	      c = (*mb_ptr2char)(reginput);
+	      c = (*mb_ptr2char)(rex->input);
 	  else
 #endif
-	      c = *reginput;
+	      c = *rex->input;
 	  switch (op)
 	  {
 	  case BOL:
-	    if (reginput != regline)
+	    if (rex->input != rex->line)
 		status = RA_NOMATCH;
 	    break;
 
@@ -3812,22 +4023,24 @@ regmatch(scan)
 	    /* Passing -1 to the getline() function provided for the search
 	     * should always return NULL if the current line is the first
 	     * line of the file. */
-	    if (reglnum != 0 || reginput != regline
-			|| (REG_MULTI && reg_getline((linenr_T)-1) != NULL))
+	    if (rex->lnum != 0 || rex->input != rex->line
+		    || (REG_MULTI && reg_getline(rex, (linenr_T)-1) != NULL))
 		status = RA_NOMATCH;
 	    break;
 
 	  case RE_EOF:
-	    if (reglnum != reg_maxline || c != NUL)
+	    if (rex->lnum != rex->reg_maxline || c != NUL)
 		status = RA_NOMATCH;
 	    break;
 
 	  case CURSOR:
 	    /* Check if the buffer is in a window and compare the
 	     * reg_win->w_cursor position to the match position. */
-	    if (reg_win == NULL
-		    || (reglnum + reg_firstlnum != reg_win->w_cursor.lnum)
-		    || ((colnr_T)(reginput - regline) != reg_win->w_cursor.col))
+	    if (rex->reg_win == NULL
+		    || (rex->lnum + rex->reg_firstlnum
+					       != rex->reg_win->w_cursor.lnum)
+		    || ((colnr_T)(rex->input - rex->line)
+						!= rex->reg_win->w_cursor.col))
 		status = RA_NOMATCH;
 	    break;
 
@@ -3842,13 +4055,14 @@ regmatch(scan)
 		pos = getmark(mark, FALSE);
 		if (pos == NULL		     /* mark doesn't exist */
 			|| pos->lnum <= 0    /* mark isn't set (in curbuf) */
-			|| (pos->lnum == reglnum + reg_firstlnum
-				? (pos->col == (colnr_T)(reginput - regline)
+			|| (pos->lnum == rex->lnum + rex->reg_firstlnum
+			      ? (pos->col == (colnr_T)(rex->input - rex->line)
 				    ? (cmp == '<' || cmp == '>')
-				    : (pos->col < (colnr_T)(reginput - regline)
+				    : (pos->col
+					   < (colnr_T)(rex->input - rex->line)
 					? cmp != '>'
 					: cmp != '<'))
-				: (pos->lnum < reglnum + reg_firstlnum
+				: (pos->lnum < rex->lnum + rex->reg_firstlnum
 				    ? cmp != '>'
 				    : cmp != '<')))
 		    status = RA_NOMATCH;
@@ -3859,14 +4073,14 @@ regmatch(scan)
 #ifdef FEAT_VISUAL
 	    /* Check if the buffer is the current buffer. and whether the
 	     * position is inside the Visual area. */
-	    if (reg_buf != curbuf || VIsual.lnum == 0)
+	    if (rex->reg_buf != curbuf || VIsual.lnum == 0)
 		status = RA_NOMATCH;
 	    else
 	    {
 		pos_T	    top, bot;
 		linenr_T    lnum;
 		colnr_T	    col;
-		win_T	    *wp = reg_win == NULL ? curwin : reg_win;
+		win_T	    *wp = rex->reg_win == NULL ? curwin : rex->reg_win;
 		int	    mode;
 
 		if (VIsual_active)
@@ -3897,8 +4111,8 @@ regmatch(scan)
 		    }
 		    mode = curbuf->b_visual.vi_mode;
 		}
-		lnum = reglnum + reg_firstlnum;
-		col = (colnr_T)(reginput - regline);
+		lnum = rex->lnum + rex->reg_firstlnum;
+		col = (colnr_T)(rex->input - rex->line);
 		if (lnum < top.lnum || lnum > bot.lnum)
 		    status = RA_NOMATCH;
 		else if (mode == 'v')
@@ -3922,8 +4136,8 @@ regmatch(scan)
 			end = end2;
 		    if (top.col == MAXCOL || bot.col == MAXCOL)
 			end = MAXCOL;
-		    cols = win_linetabsize(wp,
-				      regline, (colnr_T)(reginput - regline));
+		    cols = win_linetabsize(wp, rex->line,
+					   (colnr_T)(rex->input - rex->line));
 		    if (cols < start || cols > end - (*p_sel == 'e'))
 			status = RA_NOMATCH;
 		}
@@ -3934,24 +4148,25 @@ regmatch(scan)
 	    break;
 
 	  case RE_LNUM:
-	    if (!REG_MULTI || !re_num_cmp((long_u)(reglnum + reg_firstlnum),
-									scan))
+	    if (!REG_MULTI || !re_num_cmp(
+			     (long_u)(rex->lnum + rex->reg_firstlnum), scan))
 		status = RA_NOMATCH;
 	    break;
 
 	  case RE_COL:
-	    if (!re_num_cmp((long_u)(reginput - regline) + 1, scan))
+	    if (!re_num_cmp((long_u)(rex->input - rex->line) + 1, scan))
 		status = RA_NOMATCH;
 	    break;
 
 	  case RE_VCOL:
 	    if (!re_num_cmp((long_u)win_linetabsize(
-			    reg_win == NULL ? curwin : reg_win,
-			    regline, (colnr_T)(reginput - regline)) + 1, scan))
+			    rex->reg_win == NULL ? curwin : rex->reg_win,
+			    rex->line,
+			    (colnr_T)(rex->input - rex->line)) + 1, scan))
 		status = RA_NOMATCH;
 	    break;
 
-	  case BOW:	/* \<word; reginput points to w */
+	  case BOW:	/* \<word; rex->input points to w */
 	    if (c == NUL)	/* Can't match at end of line */
 		status = RA_NOMATCH;
 #ifdef FEAT_MBYTE
@@ -3960,23 +4175,23 @@ regmatch(scan)
 		int this_class;
 
 		/* Get class of current and previous char (if it exists). */
-		this_class = mb_get_class(reginput);
+		this_class = mb_get_class(rex->input);
 		if (this_class <= 1)
 		    status = RA_NOMATCH;  /* not on a word at all */
-		else if (reg_prev_class() == this_class)
+		else if (reg_prev_class(rex) == this_class)
 		    status = RA_NOMATCH;  /* previous char is in same word */
 	    }
 #endif
 	    else
 	    {
-		if (!vim_iswordc(c)
-			|| (reginput > regline && vim_iswordc(reginput[-1])))
+		if (!vim_iswordc(c) || (rex->input > rex->line
+					       && vim_iswordc(rex->input[-1])))
 		    status = RA_NOMATCH;
 	    }
 	    break;
 
-	  case EOW:	/* word\>; reginput points after d */
-	    if (reginput == regline)    /* Can't match at start of line */
+	  case EOW:	/* word\>; rex->input points after d */
+	    if (rex->input == rex->line)    /* Can't match at start of line */
 		status = RA_NOMATCH;
 #ifdef FEAT_MBYTE
 	    else if (has_mbyte)
@@ -3984,8 +4199,8 @@ regmatch(scan)
 		int this_class, prev_class;
 
 		/* Get class of current and previous char (if it exists). */
-		this_class = mb_get_class(reginput);
-		prev_class = reg_prev_class();
+		this_class = mb_get_class(rex->input);
+		prev_class = reg_prev_class(rex);
 		if (this_class == prev_class
 			|| prev_class == 0 || prev_class == 1)
 		    status = RA_NOMATCH;
@@ -3993,8 +4208,8 @@ regmatch(scan)
 #endif
 	    else
 	    {
-		if (!vim_iswordc(reginput[-1])
-			|| (reginput[0] != NUL && vim_iswordc(c)))
+		if (!vim_iswordc(rex->input[-1])
+			|| (rex->input[0] != NUL && vim_iswordc(c)))
 		    status = RA_NOMATCH;
 	    }
 	    break; /* Matched with EOW */
@@ -4014,21 +4229,21 @@ regmatch(scan)
 	    break;
 
 	  case SIDENT:
-	    if (VIM_ISDIGIT(*reginput) || !vim_isIDc(c))
+	    if (VIM_ISDIGIT(*rex->input) || !vim_isIDc(c))
 		status = RA_NOMATCH;
 	    else
 		ADVANCE_REGINPUT();
 	    break;
 
 	  case KWORD:
-	    if (!vim_iswordp(reginput))
+	    if (!vim_iswordp(rex->input))
 		status = RA_NOMATCH;
 	    else
 		ADVANCE_REGINPUT();
 	    break;
 
 	  case SKWORD:
-	    if (VIM_ISDIGIT(*reginput) || !vim_iswordp(reginput))
+	    if (VIM_ISDIGIT(*rex->input) || !vim_iswordp(rex->input))
 		status = RA_NOMATCH;
 	    else
 		ADVANCE_REGINPUT();
@@ -4042,21 +4257,21 @@ regmatch(scan)
 	    break;
 
 	  case SFNAME:
-	    if (VIM_ISDIGIT(*reginput) || !vim_isfilec(c))
+	    if (VIM_ISDIGIT(*rex->input) || !vim_isfilec(c))
 		status = RA_NOMATCH;
 	    else
 		ADVANCE_REGINPUT();
 	    break;
 
 	  case PRINT:
-	    if (ptr2cells(reginput) != 1)
+	    if (ptr2cells(rex->input) != 1)
 		status = RA_NOMATCH;
 	    else
 		ADVANCE_REGINPUT();
 	    break;
 
 	  case SPRINT:
-	    if (VIM_ISDIGIT(*reginput) || ptr2cells(reginput) != 1)
+	    if (VIM_ISDIGIT(*rex->input) || ptr2cells(rex->input) != 1)
 		status = RA_NOMATCH;
 	    else
 		ADVANCE_REGINPUT();
@@ -4195,12 +4410,12 @@ regmatch(scan)
 
 		opnd = OPERAND(scan);
 		/* Inline the first byte, for speed. */
-		if (*opnd != *reginput
-			&& (!ireg_ic || (
+		if (*opnd != *rex->input
+			&& (!rex->reg_ic || (
 #ifdef FEAT_MBYTE
 			    !enc_utf8 &&
 #endif
-			    TOLOWER_LOC(*opnd) != TOLOWER_LOC(*reginput))))
+			    TOLOWER_LOC(*opnd) != TOLOWER_LOC(*rex->input))))
 		    status = RA_NOMATCH;
 		else if (*opnd == NUL)
 		{
@@ -4209,30 +4424,30 @@ regmatch(scan)
 		}
 		else if (opnd[1] == NUL
 #ifdef FEAT_MBYTE
-			    && !(enc_utf8 && ireg_ic)
+			    && !(enc_utf8 && rex->reg_ic)
 #endif
 			)
-		    ++reginput;		/* matched a single char */
+		    ++rex->input;		/* matched a single char */
 		else
 		{
 		    len = (int)STRLEN(opnd);
 		    /* Need to match first byte again for multi-byte. */
-		    if (cstrncmp(opnd, reginput, &len) != 0)
+		    if (cstrncmp(rex, opnd, rex->input, &len) != 0)
 			status = RA_NOMATCH;
 #ifdef FEAT_MBYTE
 		    /* Check for following composing character. */
-		    else if (enc_utf8
-			       && UTF_COMPOSINGLIKE(reginput, reginput + len))
+		    else if (enc_utf8 && UTF_COMPOSINGLIKE(rex->input,
+							    rex->input + len))
 		    {
 			/* raaron: This code makes a composing character get
 			 * ignored, which is the correct behavior (sometimes)
 			 * for voweled Hebrew texts. */
-			if (!ireg_icombine)
+			if (!rex->reg_icombine)
 			    status = RA_NOMATCH;
 		    }
 #endif
 		    else
-			reginput += len;
+			rex->input += len;
 		}
 	    }
 	    break;
@@ -4241,7 +4456,7 @@ regmatch(scan)
 	  case ANYBUT:
 	    if (c == NUL)
 		status = RA_NOMATCH;
-	    else if ((cstrchr(OPERAND(scan), c) == NULL) == (op == ANYOF))
+	    else if ((cstrchr(rex, OPERAND(scan), c) == NULL) == (op == ANYOF))
 		status = RA_NOMATCH;
 	    else
 		ADVANCE_REGINPUT();
@@ -4270,9 +4485,9 @@ regmatch(scan)
 		    /* When only a composing char is given match at any
 		     * position where that composing char appears. */
 		    status = RA_NOMATCH;
-		    for (i = 0; reginput[i] != NUL; i += utf_char2len(inpc))
+		    for (i = 0; rex->input[i] != NUL; i += utf_char2len(inpc))
 		    {
-			inpc = mb_ptr2char(reginput + i);
+			inpc = mb_ptr2char(rex->input + i);
 			if (!utf_iscomposing(inpc))
 			{
 			    if (i > 0)
@@ -4281,7 +4496,7 @@ regmatch(scan)
 			else if (opndc == inpc)
 			{
 			    /* Include all following composing chars. */
-			    len = i + mb_ptr2len(reginput + i);
+			    len = i + mb_ptr2len(rex->input + i);
 			    status = RA_MATCH;
 			    break;
 			}
@@ -4289,12 +4504,12 @@ regmatch(scan)
 		}
 		else
 		    for (i = 0; i < len; ++i)
-			if (opnd[i] != reginput[i])
+			if (opnd[i] != rex->input[i])
 			{
 			    status = RA_NOMATCH;
 			    break;
 			}
-		reginput += len;
+		rex->input += len;
 	    }
 	    else
 		status = RA_NOMATCH;
@@ -4317,29 +4532,29 @@ regmatch(scan)
 		 * The positions are stored in "backpos" and found by the
 		 * current value of "scan", the position in the RE program.
 		 */
-		bp = (backpos_T *)backpos.ga_data;
-		for (i = 0; i < backpos.ga_len; ++i)
+		bp = (backpos_T *)rex->backpos.ga_data;
+		for (i = 0; i < rex->backpos.ga_len; ++i)
 		    if (bp[i].bp_scan == scan)
 			break;
-		if (i == backpos.ga_len)
+		if (i == rex->backpos.ga_len)
 		{
 		    /* First time at this BACK, make room to store the pos. */
-		    if (ga_grow(&backpos, 1) == FAIL)
+		    if (ga_grow(&rex->backpos, 1) == FAIL)
 			status = RA_FAIL;
 		    else
 		    {
 			/* get "ga_data" again, it may have changed */
-			bp = (backpos_T *)backpos.ga_data;
+			bp = (backpos_T *)rex->backpos.ga_data;
 			bp[i].bp_scan = scan;
-			++backpos.ga_len;
+			++rex->backpos.ga_len;
 		    }
 		}
-		else if (reg_save_equal(&bp[i].bp_pos))
+		else if (reg_save_equal(rex, &bp[i].bp_pos))
 		    /* Still at same position as last time, fail. */
 		    status = RA_NOMATCH;
 
 		if (status != RA_FAIL && status != RA_NOMATCH)
-		    reg_save(&bp[i].bp_pos, &backpos);
+		    reg_save(rex, &bp[i].bp_pos, &rex->backpos);
 	    }
 	    break;
 
@@ -4355,15 +4570,15 @@ regmatch(scan)
 	  case MOPEN + 9:
 	    {
 		no = op - MOPEN;
-		cleanup_subexpr();
-		rp = regstack_push(RS_MOPEN, scan);
+		cleanup_subexpr(rex);
+		rp = regstack_push(rex, RS_MOPEN, scan);
 		if (rp == NULL)
 		    status = RA_FAIL;
 		else
 		{
 		    rp->rs_no = no;
-		    save_se(&rp->rs_un.sesave, &reg_startpos[no],
-							     &reg_startp[no]);
+		    save_se(&rp->rs_un.sesave, &rex->reg_startpos[no],
+							&rex->reg_startp[no]);
 		    /* We simply continue and handle the result when done. */
 		}
 	    }
@@ -4371,7 +4586,7 @@ regmatch(scan)
 
 	  case NOPEN:	    /* \%( */
 	  case NCLOSE:	    /* \) after \%( */
-		if (regstack_push(RS_NOPEN, scan) == NULL)
+		if (regstack_push(rex, RS_NOPEN, scan) == NULL)
 		    status = RA_FAIL;
 		/* We simply continue and handle the result when done. */
 		break;
@@ -4388,15 +4603,15 @@ regmatch(scan)
 	  case ZOPEN + 9:
 	    {
 		no = op - ZOPEN;
-		cleanup_zsubexpr();
-		rp = regstack_push(RS_ZOPEN, scan);
+		cleanup_zsubexpr(rex);
+		rp = regstack_push(rex, RS_ZOPEN, scan);
 		if (rp == NULL)
 		    status = RA_FAIL;
 		else
 		{
 		    rp->rs_no = no;
-		    save_se(&rp->rs_un.sesave, &reg_startzpos[no],
-							     &reg_startzp[no]);
+		    save_se(&rp->rs_un.sesave, &rex->reg_startzpos[no],
+						       &rex->reg_startzp[no]);
 		    /* We simply continue and handle the result when done. */
 		}
 	    }
@@ -4415,14 +4630,15 @@ regmatch(scan)
 	  case MCLOSE + 9:
 	    {
 		no = op - MCLOSE;
-		cleanup_subexpr();
-		rp = regstack_push(RS_MCLOSE, scan);
+		cleanup_subexpr(rex);
+		rp = regstack_push(rex, RS_MCLOSE, scan);
 		if (rp == NULL)
 		    status = RA_FAIL;
 		else
 		{
 		    rp->rs_no = no;
-		    save_se(&rp->rs_un.sesave, &reg_endpos[no], &reg_endp[no]);
+		    save_se(&rp->rs_un.sesave, &rex->reg_endpos[no],
+							  &rex->reg_endp[no]);
 		    /* We simply continue and handle the result when done. */
 		}
 	    }
@@ -4440,15 +4656,15 @@ regmatch(scan)
 	  case ZCLOSE + 9:
 	    {
 		no = op - ZCLOSE;
-		cleanup_zsubexpr();
-		rp = regstack_push(RS_ZCLOSE, scan);
+		cleanup_zsubexpr(rex);
+		rp = regstack_push(rex, RS_ZCLOSE, scan);
 		if (rp == NULL)
 		    status = RA_FAIL;
 		else
 		{
 		    rp->rs_no = no;
-		    save_se(&rp->rs_un.sesave, &reg_endzpos[no],
-							      &reg_endzp[no]);
+		    save_se(&rp->rs_un.sesave, &rex->reg_endzpos[no],
+							 &rex->reg_endzp[no]);
 		    /* We simply continue and handle the result when done. */
 		}
 	    }
@@ -4471,10 +4687,11 @@ regmatch(scan)
 		char_u		*p;
 
 		no = op - BACKREF;
-		cleanup_subexpr();
+		cleanup_subexpr(rex);
 		if (!REG_MULTI)		/* Single-line regexp */
 		{
-		    if (reg_endp[no] == NULL)
+		    if (rex->reg_startp[no] == NULL
+						|| rex->reg_endp[no] == NULL)
 		    {
 			/* Backref was not set: Match an empty string. */
 			len = 0;
@@ -4483,83 +4700,88 @@ regmatch(scan)
 		    {
 			/* Compare current input with back-ref in the same
 			 * line. */
-			len = (int)(reg_endp[no] - reg_startp[no]);
-			if (cstrncmp(reg_startp[no], reginput, &len) != 0)
+			len = (int)(rex->reg_endp[no] - rex->reg_startp[no]);
+			if (cstrncmp(rex, rex->reg_startp[no], rex->input,
+								 &len) != 0)
 			    status = RA_NOMATCH;
 		    }
 		}
 		else				/* Multi-line regexp */
 		{
-		    if (reg_endpos[no].lnum < 0)
+		    if (rex->reg_startpos[no].lnum < 0
+					       || rex->reg_endpos[no].lnum < 0)
 		    {
 			/* Backref was not set: Match an empty string. */
 			len = 0;
 		    }
 		    else
 		    {
-			if (reg_startpos[no].lnum == reglnum
-				&& reg_endpos[no].lnum == reglnum)
+			if (rex->reg_startpos[no].lnum == rex->lnum
+				&& rex->reg_endpos[no].lnum == rex->lnum)
 			{
 			    /* Compare back-ref within the current line. */
-			    len = reg_endpos[no].col - reg_startpos[no].col;
-			    if (cstrncmp(regline + reg_startpos[no].col,
-							  reginput, &len) != 0)
+			    len = rex->reg_endpos[no].col
+						   - rex->reg_startpos[no].col;
+			    if (cstrncmp(rex,
+				       rex->line + rex->reg_startpos[no].col,
+				       rex->input, &len) != 0)
 				status = RA_NOMATCH;
 			}
 			else
 			{
 			    /* Messy situation: Need to compare between two
 			     * lines. */
-			    ccol = reg_startpos[no].col;
-			    clnum = reg_startpos[no].lnum;
+			    ccol = rex->reg_startpos[no].col;
+			    clnum = rex->reg_startpos[no].lnum;
 			    for (;;)
 			    {
 				/* Since getting one line may invalidate
 				 * the other, need to make copy.  Slow! */
-				if (regline != reg_tofree)
+				if (rex->line != rex->reg_tofree)
 				{
-				    len = (int)STRLEN(regline);
-				    if (reg_tofree == NULL
-						 || len >= (int)reg_tofreelen)
+				    len = (int)STRLEN(rex->line);
+				    if (rex->reg_tofree == NULL
+					    || len >= (int)rex->reg_tofreelen)
 				    {
 					len += 50;	/* get some extra */
-					vim_free(reg_tofree);
-					reg_tofree = alloc(len);
-					if (reg_tofree == NULL)
+					vim_free(rex->reg_tofree);
+					rex->reg_tofree = alloc(len);
+					if (rex->reg_tofree == NULL)
 					{
 					    status = RA_FAIL; /* outof memory!*/
 					    break;
 					}
-					reg_tofreelen = len;
+					rex->reg_tofreelen = len;
 				    }
-				    STRCPY(reg_tofree, regline);
-				    reginput = reg_tofree
-						       + (reginput - regline);
-				    regline = reg_tofree;
+				    STRCPY(rex->reg_tofree, rex->line);
+				    rex->input = rex->reg_tofree
+						    + (rex->input - rex->line);
+				    rex->line = rex->reg_tofree;
 				}
 
 				/* Get the line to compare with. */
-				p = reg_getline(clnum);
-				if (clnum == reg_endpos[no].lnum)
-				    len = reg_endpos[no].col - ccol;
+				p = reg_getline(rex, clnum);
+				if (clnum == rex->reg_endpos[no].lnum)
+				    len = rex->reg_endpos[no].col - ccol;
 				else
 				    len = (int)STRLEN(p + ccol);
 
-				if (cstrncmp(p + ccol, reginput, &len) != 0)
+				if (cstrncmp(rex, p + ccol, rex->input,
+								 &len) != 0)
 				{
 				    status = RA_NOMATCH;  /* doesn't match */
 				    break;
 				}
-				if (clnum == reg_endpos[no].lnum)
+				if (clnum == rex->reg_endpos[no].lnum)
 				    break;		/* match and at end! */
-				if (reglnum >= reg_maxline)
+				if (rex->lnum >= rex->reg_maxline)
 				{
 				    status = RA_NOMATCH;  /* text too short */
 				    break;
 				}
 
 				/* Advance to next line. */
-				reg_nextline();
+				reg_nextline(rex);
 				++clnum;
 				ccol = 0;
 				if (got_int)
@@ -4569,14 +4791,15 @@ regmatch(scan)
 				}
 			    }
 
-			    /* found a match!  Note that regline may now point
-			     * to a copy of the line, that should not matter. */
+			    /* found a match!  Note that rex->line may now
+			     * point to a copy of the line, that should not
+			     * matter. */
 			}
 		    }
 		}
 
 		/* Matched the backref, skip over it. */
-		reginput += len;
+		rex->input += len;
 	    }
 	    break;
 
@@ -4593,17 +4816,17 @@ regmatch(scan)
 	    {
 		int	len;
 
-		cleanup_zsubexpr();
+		cleanup_zsubexpr(rex);
 		no = op - ZREF;
 		if (re_extmatch_in != NULL
 			&& re_extmatch_in->matches[no] != NULL)
 		{
 		    len = (int)STRLEN(re_extmatch_in->matches[no]);
-		    if (cstrncmp(re_extmatch_in->matches[no],
-							  reginput, &len) != 0)
+		    if (cstrncmp(rex, re_extmatch_in->matches[no],
+						      rex->input, &len) != 0)
 			status = RA_NOMATCH;
 		    else
-			reginput += len;
+			rex->input += len;
 		}
 		else
 		{
@@ -4619,7 +4842,7 @@ regmatch(scan)
 		    next = OPERAND(scan);	/* Avoid recursion. */
 		else
 		{
-		    rp = regstack_push(RS_BRANCH, scan);
+		    rp = regstack_push(rex, RS_BRANCH, scan);
 		    if (rp == NULL)
 			status = RA_FAIL;
 		    else
@@ -4632,16 +4855,16 @@ regmatch(scan)
 	    {
 		if (OP(next) == BRACE_SIMPLE)
 		{
-		    bl_minval = OPERAND_MIN(scan);
-		    bl_maxval = OPERAND_MAX(scan);
+		    rex->bl_minval = OPERAND_MIN(scan);
+		    rex->bl_maxval = OPERAND_MAX(scan);
 		}
 		else if (OP(next) >= BRACE_COMPLEX
 			&& OP(next) < BRACE_COMPLEX + 10)
 		{
 		    no = OP(next) - BRACE_COMPLEX;
-		    brace_min[no] = OPERAND_MIN(scan);
-		    brace_max[no] = OPERAND_MAX(scan);
-		    brace_count[no] = 0;
+		    rex->brace_min[no] = OPERAND_MIN(scan);
+		    rex->brace_max[no] = OPERAND_MAX(scan);
+		    rex->brace_count[no] = 0;
 		}
 		else
 		{
@@ -4663,19 +4886,20 @@ regmatch(scan)
 	  case BRACE_COMPLEX + 9:
 	    {
 		no = op - BRACE_COMPLEX;
-		++brace_count[no];
+		++rex->brace_count[no];
 
 		/* If not matched enough times yet, try one more */
-		if (brace_count[no] <= (brace_min[no] <= brace_max[no]
-					     ? brace_min[no] : brace_max[no]))
+		if (rex->brace_count[no] <= (rex->brace_min[no]
+							   <= rex->brace_max[no]
+				  ? rex->brace_min[no] : rex->brace_max[no]))
 		{
-		    rp = regstack_push(RS_BRCPLX_MORE, scan);
+		    rp = regstack_push(rex, RS_BRCPLX_MORE, scan);
 		    if (rp == NULL)
 			status = RA_FAIL;
 		    else
 		    {
 			rp->rs_no = no;
-			reg_save(&rp->rs_un.regsave, &backpos);
+			reg_save(rex, &rp->rs_un.regsave, &rex->backpos);
 			next = OPERAND(scan);
 			/* We continue and handle the result when done. */
 		    }
@@ -4683,18 +4907,18 @@ regmatch(scan)
 		}
 
 		/* If matched enough times, may try matching some more */
-		if (brace_min[no] <= brace_max[no])
+		if (rex->brace_min[no] <= rex->brace_max[no])
 		{
 		    /* Range is the normal way around, use longest match */
-		    if (brace_count[no] <= brace_max[no])
+		    if (rex->brace_count[no] <= rex->brace_max[no])
 		    {
-			rp = regstack_push(RS_BRCPLX_LONG, scan);
+			rp = regstack_push(rex, RS_BRCPLX_LONG, scan);
 			if (rp == NULL)
 			    status = RA_FAIL;
 			else
 			{
 			    rp->rs_no = no;
-			    reg_save(&rp->rs_un.regsave, &backpos);
+			    reg_save(rex, &rp->rs_un.regsave, &rex->backpos);
 			    next = OPERAND(scan);
 			    /* We continue and handle the result when done. */
 			}
@@ -4703,14 +4927,14 @@ regmatch(scan)
 		else
 		{
 		    /* Range is backwards, use shortest match first */
-		    if (brace_count[no] <= brace_min[no])
+		    if (rex->brace_count[no] <= rex->brace_min[no])
 		    {
-			rp = regstack_push(RS_BRCPLX_SHORT, scan);
+			rp = regstack_push(rex, RS_BRCPLX_SHORT, scan);
 			if (rp == NULL)
 			    status = RA_FAIL;
 			else
 			{
-			    reg_save(&rp->rs_un.regsave, &backpos);
+			    reg_save(rex, &rp->rs_un.regsave, &rex->backpos);
 			    /* We continue and handle the result when done. */
 			}
 		    }
@@ -4731,7 +4955,7 @@ regmatch(scan)
 		if (OP(next) == EXACTLY)
 		{
 		    rst.nextb = *OPERAND(next);
-		    if (ireg_ic)
+		    if (rex->reg_ic)
 		    {
 			if (isupper(rst.nextb))
 			    rst.nextb_ic = TOLOWER_LOC(rst.nextb);
@@ -4753,8 +4977,8 @@ regmatch(scan)
 		}
 		else
 		{
-		    rst.minval = bl_minval;
-		    rst.maxval = bl_maxval;
+		    rst.minval = rex->bl_minval;
+		    rst.maxval = rex->bl_maxval;
 		}
 
 		/*
@@ -4763,7 +4987,7 @@ regmatch(scan)
 		 * minimal number (since the range is backwards, that's also
 		 * maxval!).
 		 */
-		rst.count = regrepeat(OPERAND(scan), rst.maxval);
+		rst.count = regrepeat(rex, OPERAND(scan), rst.maxval);
 		if (got_int)
 		{
 		    status = RA_FAIL;
@@ -4775,17 +4999,18 @@ regmatch(scan)
 		    /* It could match.  Prepare for trying to match what
 		     * follows.  The code is below.  Parameters are stored in
 		     * a regstar_T on the regstack. */
-		    if ((long)((unsigned)regstack.ga_len >> 10) >= p_mmp)
+		    if ((long)((unsigned)rex->regstack.ga_len >> 10) >= p_mmp)
 		    {
 			EMSG(_(e_maxmempat));
 			status = RA_FAIL;
 		    }
-		    else if (ga_grow(&regstack, sizeof(regstar_T)) == FAIL)
+		    else if (ga_grow(&rex->regstack,
+						 sizeof(regstar_T)) == FAIL)
 			status = RA_FAIL;
 		    else
 		    {
-			regstack.ga_len += sizeof(regstar_T);
-			rp = regstack_push(rst.minval <= rst.maxval
+			rex->regstack.ga_len += sizeof(regstar_T);
+			rp = regstack_push(rex, rst.minval <= rst.maxval
 					? RS_STAR_LONG : RS_STAR_SHORT, scan);
 			if (rp == NULL)
 			    status = RA_FAIL;
@@ -4805,13 +5030,13 @@ regmatch(scan)
 	  case NOMATCH:
 	  case MATCH:
 	  case SUBPAT:
-	    rp = regstack_push(RS_NOMATCH, scan);
+	    rp = regstack_push(rex, RS_NOMATCH, scan);
 	    if (rp == NULL)
 		status = RA_FAIL;
 	    else
 	    {
 		rp->rs_no = op;
-		reg_save(&rp->rs_un.regsave, &backpos);
+		reg_save(rex, &rp->rs_un.regsave, &rex->backpos);
 		next = OPERAND(scan);
 		/* We continue and handle the result when done. */
 	    }
@@ -4820,23 +5045,23 @@ regmatch(scan)
 	  case BEHIND:
 	  case NOBEHIND:
 	    /* Need a bit of room to store extra positions. */
-	    if ((long)((unsigned)regstack.ga_len >> 10) >= p_mmp)
+	    if ((long)((unsigned)rex->regstack.ga_len >> 10) >= p_mmp)
 	    {
 		EMSG(_(e_maxmempat));
 		status = RA_FAIL;
 	    }
-	    else if (ga_grow(&regstack, sizeof(regbehind_T)) == FAIL)
+	    else if (ga_grow(&rex->regstack, sizeof(regbehind_T)) == FAIL)
 		status = RA_FAIL;
 	    else
 	    {
-		regstack.ga_len += sizeof(regbehind_T);
-		rp = regstack_push(RS_BEHIND1, scan);
+		rex->regstack.ga_len += sizeof(regbehind_T);
+		rp = regstack_push(rex, RS_BEHIND1, scan);
 		if (rp == NULL)
 		    status = RA_FAIL;
 		else
 		{
 		    rp->rs_no = op;
-		    reg_save(&rp->rs_un.regsave, &backpos);
+		    reg_save(rex, &rp->rs_un.regsave, &rex->backpos);
 		    /* First try if what follows matches.  If it does then we
 		     * check the behind match by looping. */
 		}
@@ -4846,22 +5071,24 @@ regmatch(scan)
 	  case BHPOS:
 	    if (REG_MULTI)
 	    {
-		if (behind_pos.rs_u.pos.col != (colnr_T)(reginput - regline)
-			|| behind_pos.rs_u.pos.lnum != reglnum)
+		if (rex->behind_pos.rs_u.pos.col
+				       != (colnr_T)(rex->input - rex->line)
+			|| rex->behind_pos.rs_u.pos.lnum != rex->lnum)
 		    status = RA_NOMATCH;
 	    }
-	    else if (behind_pos.rs_u.ptr != reginput)
+	    else if (rex->behind_pos.rs_u.ptr != rex->input)
 		status = RA_NOMATCH;
 	    break;
 
 	  case NEWL:
-	    if ((c != NUL || !REG_MULTI || reglnum > reg_maxline
-			     || reg_line_lbr) && (c != '\n' || !reg_line_lbr))
+	    if ((c != NUL || !REG_MULTI || rex->lnum > rex->reg_maxline
+			     || rex->reg_line_lbr)
+				     && (c != '\n' || !rex->reg_line_lbr))
 		status = RA_NOMATCH;
-	    else if (reg_line_lbr)
+	    else if (rex->reg_line_lbr)
 		ADVANCE_REGINPUT();
 	    else
-		reg_nextline();
+		reg_nextline(rex);
 	    break;
 
 	  case END:
@@ -4891,75 +5118,76 @@ regmatch(scan)
      * If there is something on the regstack execute the code for the state.
      * If the state is popped then loop and use the older state.
      */
-    while (regstack.ga_len > 0 && status != RA_FAIL)
+    while (rex->regstack.ga_len > 0 && status != RA_FAIL)
     {
-	rp = (regitem_T *)((char *)regstack.ga_data + regstack.ga_len) - 1;
+	rp = (regitem_T *)((char *)rex->regstack.ga_data
+						   + rex->regstack.ga_len) - 1;
 	switch (rp->rs_state)
 	{
 	  case RS_NOPEN:
 	    /* Result is passed on as-is, simply pop the state. */
-	    regstack_pop(&scan);
+	    regstack_pop(rex, &scan);
 	    break;
 
 	  case RS_MOPEN:
 	    /* Pop the state.  Restore pointers when there is no match. */
 	    if (status == RA_NOMATCH)
-		restore_se(&rp->rs_un.sesave, &reg_startpos[rp->rs_no],
-						  &reg_startp[rp->rs_no]);
-	    regstack_pop(&scan);
+		restore_se(&rp->rs_un.sesave, &rex->reg_startpos[rp->rs_no],
+						  &rex->reg_startp[rp->rs_no]);
+	    regstack_pop(rex, &scan);
 	    break;
 
 #ifdef FEAT_SYN_HL
 	  case RS_ZOPEN:
 	    /* Pop the state.  Restore pointers when there is no match. */
 	    if (status == RA_NOMATCH)
-		restore_se(&rp->rs_un.sesave, &reg_startzpos[rp->rs_no],
-						 &reg_startzp[rp->rs_no]);
-	    regstack_pop(&scan);
+		restore_se(&rp->rs_un.sesave, &rex->reg_startzpos[rp->rs_no],
+						 &rex->reg_startzp[rp->rs_no]);
+	    regstack_pop(rex, &scan);
 	    break;
 #endif
 
 	  case RS_MCLOSE:
 	    /* Pop the state.  Restore pointers when there is no match. */
 	    if (status == RA_NOMATCH)
-		restore_se(&rp->rs_un.sesave, &reg_endpos[rp->rs_no],
-						    &reg_endp[rp->rs_no]);
-	    regstack_pop(&scan);
+		restore_se(&rp->rs_un.sesave, &rex->reg_endpos[rp->rs_no],
+						    &rex->reg_endp[rp->rs_no]);
+	    regstack_pop(rex, &scan);
 	    break;
 
 #ifdef FEAT_SYN_HL
 	  case RS_ZCLOSE:
 	    /* Pop the state.  Restore pointers when there is no match. */
 	    if (status == RA_NOMATCH)
-		restore_se(&rp->rs_un.sesave, &reg_endzpos[rp->rs_no],
-						   &reg_endzp[rp->rs_no]);
-	    regstack_pop(&scan);
+		restore_se(&rp->rs_un.sesave, &rex->reg_endzpos[rp->rs_no],
+						   &rex->reg_endzp[rp->rs_no]);
+	    regstack_pop(rex, &scan);
 	    break;
 #endif
 
 	  case RS_BRANCH:
 	    if (status == RA_MATCH)
 		/* this branch matched, use it */
-		regstack_pop(&scan);
+		regstack_pop(rex, &scan);
 	    else
 	    {
 		if (status != RA_BREAK)
 		{
 		    /* After a non-matching branch: try next one. */
-		    reg_restore(&rp->rs_un.regsave, &backpos);
+		    reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
 		    scan = rp->rs_scan;
 		}
 		if (scan == NULL || OP(scan) != BRANCH)
 		{
 		    /* no more branches, didn't find a match */
 		    status = RA_NOMATCH;
-		    regstack_pop(&scan);
+		    regstack_pop(rex, &scan);
 		}
 		else
 		{
 		    /* Prepare to try a branch. */
 		    rp->rs_scan = regnext(scan);
-		    reg_save(&rp->rs_un.regsave, &backpos);
+		    reg_save(rex, &rp->rs_un.regsave, &rex->backpos);
 		    scan = OPERAND(scan);
 		}
 	    }
@@ -4969,10 +5197,10 @@ regmatch(scan)
 	    /* Pop the state.  Restore pointers when there is no match. */
 	    if (status == RA_NOMATCH)
 	    {
-		reg_restore(&rp->rs_un.regsave, &backpos);
-		--brace_count[rp->rs_no];	/* decrement match count */
+		reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
+		--rex->brace_count[rp->rs_no];	/* decrement match count */
 	    }
-	    regstack_pop(&scan);
+	    regstack_pop(rex, &scan);
 	    break;
 
 	  case RS_BRCPLX_LONG:
@@ -4980,12 +5208,12 @@ regmatch(scan)
 	    if (status == RA_NOMATCH)
 	    {
 		/* There was no match, but we did find enough matches. */
-		reg_restore(&rp->rs_un.regsave, &backpos);
-		--brace_count[rp->rs_no];
+		reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
+		--rex->brace_count[rp->rs_no];
 		/* continue with the items after "\{}" */
 		status = RA_CONT;
 	    }
-	    regstack_pop(&scan);
+	    regstack_pop(rex, &scan);
 	    if (status == RA_CONT)
 		scan = regnext(scan);
 	    break;
@@ -4994,8 +5222,8 @@ regmatch(scan)
 	    /* Pop the state.  Restore pointers when there is no match. */
 	    if (status == RA_NOMATCH)
 		/* There was no match, try to match one more item. */
-		reg_restore(&rp->rs_un.regsave, &backpos);
-	    regstack_pop(&scan);
+		reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
+	    regstack_pop(rex, &scan);
 	    if (status == RA_NOMATCH)
 	    {
 		scan = OPERAND(scan);
@@ -5013,9 +5241,9 @@ regmatch(scan)
 	    {
 		status = RA_CONT;
 		if (rp->rs_no != SUBPAT)	/* zero-width */
-		    reg_restore(&rp->rs_un.regsave, &backpos);
+		    reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
 	    }
-	    regstack_pop(&scan);
+	    regstack_pop(rex, &scan);
 	    if (status == RA_CONT)
 		scan = regnext(scan);
 	    break;
@@ -5023,8 +5251,8 @@ regmatch(scan)
 	  case RS_BEHIND1:
 	    if (status == RA_NOMATCH)
 	    {
-		regstack_pop(&scan);
-		regstack.ga_len -= sizeof(regbehind_T);
+		regstack_pop(rex, &scan);
+		rex->regstack.ga_len -= sizeof(regbehind_T);
 	    }
 	    else
 	    {
@@ -5035,7 +5263,8 @@ regmatch(scan)
 		 * the current position. */
 
 		/* save the position after the found match for next */
-		reg_save(&(((regbehind_T *)rp) - 1)->save_after, &backpos);
+		reg_save(rex, &(((regbehind_T *)rp) - 1)->save_after,
+							       &rex->backpos);
 
 		/* start looking for a match with operand at the current
 		 * position.  Go back one character until we find the
@@ -5043,12 +5272,12 @@ regmatch(scan)
 		 * line (for multi-line matching).
 		 * Set behind_pos to where the match should end, BHPOS
 		 * will match it.  Save the current value. */
-		(((regbehind_T *)rp) - 1)->save_behind = behind_pos;
-		behind_pos = rp->rs_un.regsave;
+		(((regbehind_T *)rp) - 1)->save_behind = rex->behind_pos;
+		rex->behind_pos = rp->rs_un.regsave;
 
 		rp->rs_state = RS_BEHIND2;
 
-		reg_restore(&rp->rs_un.regsave, &backpos);
+		reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
 		scan = OPERAND(rp->rs_scan);
 	    }
 	    break;
@@ -5057,18 +5286,18 @@ regmatch(scan)
 	    /*
 	     * Looping for BEHIND / NOBEHIND match.
 	     */
-	    if (status == RA_MATCH && reg_save_equal(&behind_pos))
+	    if (status == RA_MATCH && reg_save_equal(rex, &rex->behind_pos))
 	    {
 		/* found a match that ends where "next" started */
-		behind_pos = (((regbehind_T *)rp) - 1)->save_behind;
+		rex->behind_pos = (((regbehind_T *)rp) - 1)->save_behind;
 		if (rp->rs_no == BEHIND)
-		    reg_restore(&(((regbehind_T *)rp) - 1)->save_after,
-								    &backpos);
+		    reg_restore(rex, &(((regbehind_T *)rp) - 1)->save_after,
+							       &rex->backpos);
 		else
 		    /* But we didn't want a match. */
 		    status = RA_NOMATCH;
-		regstack_pop(&scan);
-		regstack.ga_len -= sizeof(regbehind_T);
+		regstack_pop(rex, &scan);
+		rex->regstack.ga_len -= sizeof(regbehind_T);
 	    }
 	    else
 	    {
@@ -5080,16 +5309,17 @@ regmatch(scan)
 		    if (rp->rs_un.regsave.rs_u.pos.col == 0)
 		    {
 			if (rp->rs_un.regsave.rs_u.pos.lnum
-					< behind_pos.rs_u.pos.lnum
-				|| reg_getline(
+					< rex->behind_pos.rs_u.pos.lnum
+				|| reg_getline(rex, 
 					--rp->rs_un.regsave.rs_u.pos.lnum)
 								  == NULL)
 			    no = FAIL;
 			else
 			{
-			    reg_restore(&rp->rs_un.regsave, &backpos);
+			    reg_restore(rex, &rp->rs_un.regsave,
+							       &rex->backpos);
 			    rp->rs_un.regsave.rs_u.pos.col =
-						 (colnr_T)STRLEN(regline);
+						 (colnr_T)STRLEN(rex->line);
 			}
 		    }
 		    else
@@ -5097,7 +5327,7 @@ regmatch(scan)
 		}
 		else
 		{
-		    if (rp->rs_un.regsave.rs_u.ptr == regline)
+		    if (rp->rs_un.regsave.rs_u.ptr == rex->line)
 			no = FAIL;
 		    else
 			--rp->rs_un.regsave.rs_u.ptr;
@@ -5105,23 +5335,24 @@ regmatch(scan)
 		if (no == OK)
 		{
 		    /* Advanced, prepare for finding match again. */
-		    reg_restore(&rp->rs_un.regsave, &backpos);
+		    reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
 		    scan = OPERAND(rp->rs_scan);
 		}
 		else
 		{
 		    /* Can't advance.  For NOBEHIND that's a match. */
-		    behind_pos = (((regbehind_T *)rp) - 1)->save_behind;
+		    rex->behind_pos = (((regbehind_T *)rp) - 1)->save_behind;
 		    if (rp->rs_no == NOBEHIND)
 		    {
-			reg_restore(&(((regbehind_T *)rp) - 1)->save_after,
-								    &backpos);
+			reg_restore(rex,
+				    &(((regbehind_T *)rp) - 1)->save_after,
+				    &rex->backpos);
 			status = RA_MATCH;
 		    }
 		    else
 			status = RA_NOMATCH;
-		    regstack_pop(&scan);
-		    regstack.ga_len -= sizeof(regbehind_T);
+		    regstack_pop(rex, &scan);
+		    rex->regstack.ga_len -= sizeof(regbehind_T);
 		}
 	    }
 	    break;
@@ -5133,14 +5364,14 @@ regmatch(scan)
 
 		if (status == RA_MATCH)
 		{
-		    regstack_pop(&scan);
-		    regstack.ga_len -= sizeof(regstar_T);
+		    regstack_pop(rex, &scan);
+		    rex->regstack.ga_len -= sizeof(regstar_T);
 		    break;
 		}
 
 		/* Tried once already, restore input pointers. */
 		if (status != RA_BREAK)
-		    reg_restore(&rp->rs_un.regsave, &backpos);
+		    reg_restore(rex, &rp->rs_un.regsave, &rex->backpos);
 
 		/* Repeat until we found a position where it could match. */
 		for (;;)
@@ -5154,20 +5385,20 @@ regmatch(scan)
 			     * didn't match -- back up one char. */
 			    if (--rst->count < rst->minval)
 				break;
-			    if (reginput == regline)
+			    if (rex->input == rex->line)
 			    {
 				/* backup to last char of previous line */
-				--reglnum;
-				regline = reg_getline(reglnum);
+				--rex->lnum;
+				rex->line = reg_getline(rex, rex->lnum);
 				/* Just in case regrepeat() didn't count
 				 * right. */
-				if (regline == NULL)
+				if (rex->line == NULL)
 				    break;
-				reginput = regline + STRLEN(regline);
+				rex->input = rex->line + STRLEN(rex->line);
 				fast_breakcheck();
 			    }
 			    else
-				mb_ptr_back(regline, reginput);
+				mb_ptr_back(rex->line, rex->input);
 			}
 			else
 			{
@@ -5176,7 +5407,7 @@ regmatch(scan)
 			     * Couldn't or didn't match: try advancing one
 			     * char. */
 			    if (rst->count == rst->minval
-				  || regrepeat(OPERAND(rp->rs_scan), 1L) == 0)
+			     || regrepeat(rex, OPERAND(rp->rs_scan), 1L) == 0)
 				break;
 			    ++rst->count;
 			}
@@ -5187,10 +5418,10 @@ regmatch(scan)
 			status = RA_NOMATCH;
 
 		    /* If it could match, try it. */
-		    if (rst->nextb == NUL || *reginput == rst->nextb
-					     || *reginput == rst->nextb_ic)
+		    if (rst->nextb == NUL || *rex->input == rst->nextb
+					     || *rex->input == rst->nextb_ic)
 		    {
-			reg_save(&rp->rs_un.regsave, &backpos);
+			reg_save(rex, &rp->rs_un.regsave, &rex->backpos);
 			scan = regnext(rp->rs_scan);
 			status = RA_CONT;
 			break;
@@ -5199,8 +5430,8 @@ regmatch(scan)
 		if (status != RA_CONT)
 		{
 		    /* Failed. */
-		    regstack_pop(&scan);
-		    regstack.ga_len -= sizeof(regstar_T);
+		    regstack_pop(rex, &scan);
+		    rex->regstack.ga_len -= sizeof(regstar_T);
 		    status = RA_NOMATCH;
 		}
 	    }
@@ -5209,8 +5440,8 @@ regmatch(scan)
 
 	/* If we want to continue the inner loop or didn't pop a state
 	 * continue matching loop */
-	if (status == RA_CONT || rp == (regitem_T *)
-			     ((char *)regstack.ga_data + regstack.ga_len) - 1)
+	if (status == RA_CONT || rp == (regitem_T *)((char *)
+			     rex->regstack.ga_data + rex->regstack.ga_len) - 1)
 	    break;
     }
 
@@ -5221,7 +5452,7 @@ regmatch(scan)
     /*
      * If the regstack is empty or something failed we are done.
      */
-    if (regstack.ga_len == 0 || status == RA_FAIL)
+    if (rex->regstack.ga_len == 0 || status == RA_FAIL)
     {
 	if (scan == NULL)
 	{
@@ -5249,25 +5480,26 @@ regmatch(scan)
  * Returns pointer to new item.  Returns NULL when out of memory.
  */
     static regitem_T *
-regstack_push(state, scan)
+regstack_push(rex, state, scan)
+    regexec_T	*rex;
     regstate_T	state;
     char_u	*scan;
 {
     regitem_T	*rp;
 
-    if ((long)((unsigned)regstack.ga_len >> 10) >= p_mmp)
+    if ((long)((unsigned)rex->regstack.ga_len >> 10) >= p_mmp)
     {
 	EMSG(_(e_maxmempat));
 	return NULL;
     }
-    if (ga_grow(&regstack, sizeof(regitem_T)) == FAIL)
+    if (ga_grow(&rex->regstack, sizeof(regitem_T)) == FAIL)
 	return NULL;
 
-    rp = (regitem_T *)((char *)regstack.ga_data + regstack.ga_len);
+    rp = (regitem_T *)((char *)rex->regstack.ga_data + rex->regstack.ga_len);
     rp->rs_state = state;
     rp->rs_scan = scan;
 
-    regstack.ga_len += sizeof(regitem_T);
+    rex->regstack.ga_len += sizeof(regitem_T);
     return rp;
 }
 
@@ -5275,23 +5507,26 @@ regstack_push(state, scan)
  * Pop an item from the regstack.
  */
     static void
-regstack_pop(scan)
+regstack_pop(rex, scan)
+    regexec_T	*rex;
     char_u	**scan;
 {
     regitem_T	*rp;
 
-    rp = (regitem_T *)((char *)regstack.ga_data + regstack.ga_len) - 1;
+    rp = (regitem_T *)((char *)rex->regstack.ga_data
+						   + rex->regstack.ga_len) - 1;
     *scan = rp->rs_scan;
 
-    regstack.ga_len -= sizeof(regitem_T);
+    rex->regstack.ga_len -= sizeof(regitem_T);
 }
 
 /*
  * regrepeat - repeatedly match something simple, return how many.
- * Advances reginput (and reglnum) to just after the matched chars.
+ * Advances rex->input (and rex->lnum) to just after the matched chars.
  */
     static int
-regrepeat(p, maxcount)
+regrepeat(rex, p, maxcount)
+    regexec_T	*rex;
     char_u	*p;
     long	maxcount;   /* maximum number of matches allowed */
 {
@@ -5301,7 +5536,7 @@ regrepeat(p, maxcount)
     int		mask;
     int		testval = 0;
 
-    scan = reginput;	    /* Make local copy of reginput for speed. */
+    scan = rex->input;	    /* Make local copy of rex->input for speed. */
     opnd = OPERAND(p);
     switch (OP(p))
     {
@@ -5316,12 +5551,12 @@ regrepeat(p, maxcount)
 		++count;
 		mb_ptr_adv(scan);
 	    }
-	    if (!REG_MULTI || !WITH_NL(OP(p)) || reglnum > reg_maxline
-					 || reg_line_lbr || count == maxcount)
+	    if (!REG_MULTI || !WITH_NL(OP(p)) || rex->lnum > rex->reg_maxline
+				    || rex->reg_line_lbr || count == maxcount)
 		break;
 	    ++count;		/* count the line-break */
-	    reg_nextline();
-	    scan = reginput;
+	    reg_nextline(rex);
+	    scan = rex->input;
 	    if (got_int)
 		break;
 	}
@@ -5341,15 +5576,15 @@ regrepeat(p, maxcount)
 	    }
 	    else if (*scan == NUL)
 	    {
-		if (!REG_MULTI || !WITH_NL(OP(p)) || reglnum > reg_maxline
-							      || reg_line_lbr)
+		if (!REG_MULTI || !WITH_NL(OP(p))
+			|| rex->lnum > rex->reg_maxline || rex->reg_line_lbr)
 		    break;
-		reg_nextline();
-		scan = reginput;
+		reg_nextline(rex);
+		scan = rex->input;
 		if (got_int)
 		    break;
 	    }
-	    else if (reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
+	    else if (rex->reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
 		++scan;
 	    else
 		break;
@@ -5371,15 +5606,15 @@ regrepeat(p, maxcount)
 	    }
 	    else if (*scan == NUL)
 	    {
-		if (!REG_MULTI || !WITH_NL(OP(p)) || reglnum > reg_maxline
-							      || reg_line_lbr)
+		if (!REG_MULTI || !WITH_NL(OP(p))
+			|| rex->lnum > rex->reg_maxline || rex->reg_line_lbr)
 		    break;
-		reg_nextline();
-		scan = reginput;
+		reg_nextline(rex);
+		scan = rex->input;
 		if (got_int)
 		    break;
 	    }
-	    else if (reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
+	    else if (rex->reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
 		++scan;
 	    else
 		break;
@@ -5401,15 +5636,15 @@ regrepeat(p, maxcount)
 	    }
 	    else if (*scan == NUL)
 	    {
-		if (!REG_MULTI || !WITH_NL(OP(p)) || reglnum > reg_maxline
-							      || reg_line_lbr)
+		if (!REG_MULTI || !WITH_NL(OP(p))
+			|| rex->lnum > rex->reg_maxline || rex->reg_line_lbr)
 		    break;
-		reg_nextline();
-		scan = reginput;
+		reg_nextline(rex);
+		scan = rex->input;
 		if (got_int)
 		    break;
 	    }
-	    else if (reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
+	    else if (rex->reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
 		++scan;
 	    else
 		break;
@@ -5427,11 +5662,11 @@ regrepeat(p, maxcount)
 	{
 	    if (*scan == NUL)
 	    {
-		if (!REG_MULTI || !WITH_NL(OP(p)) || reglnum > reg_maxline
-							      || reg_line_lbr)
+		if (!REG_MULTI || !WITH_NL(OP(p))
+			|| rex->lnum > rex->reg_maxline || rex->reg_line_lbr)
 		    break;
-		reg_nextline();
-		scan = reginput;
+		reg_nextline(rex);
+		scan = rex->input;
 		if (got_int)
 		    break;
 	    }
@@ -5439,7 +5674,7 @@ regrepeat(p, maxcount)
 	    {
 		mb_ptr_adv(scan);
 	    }
-	    else if (reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
+	    else if (rex->reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
 		++scan;
 	    else
 		break;
@@ -5458,11 +5693,11 @@ do_class:
 #endif
 	    if (*scan == NUL)
 	    {
-		if (!REG_MULTI || !WITH_NL(OP(p)) || reglnum > reg_maxline
-							      || reg_line_lbr)
+		if (!REG_MULTI || !WITH_NL(OP(p))
+			|| rex->lnum > rex->reg_maxline || rex->reg_line_lbr)
 		    break;
-		reg_nextline();
-		scan = reginput;
+		reg_nextline(rex);
+		scan = rex->input;
 		if (got_int)
 		    break;
 	    }
@@ -5476,7 +5711,7 @@ do_class:
 #endif
 	    else if ((class_tab[*scan] & mask) == testval)
 		++scan;
-	    else if (reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
+	    else if (rex->reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
 		++scan;
 	    else
 		break;
@@ -5559,7 +5794,7 @@ do_class:
 
 	    /* This doesn't do a multi-byte character, because a MULTIBYTECODE
 	     * would have been used for it. */
-	    if (ireg_ic)
+	    if (rex->reg_ic)
 	    {
 		cu = TOUPPER_LOC(*opnd);
 		cl = TOLOWER_LOC(*opnd);
@@ -5590,14 +5825,14 @@ do_class:
 	     * compiling the program). */
 	    if ((len = (*mb_ptr2len)(opnd)) > 1)
 	    {
-		if (ireg_ic && enc_utf8)
+		if (rex->reg_ic && enc_utf8)
 		    cf = utf_fold(utf_ptr2char(opnd));
 		while (count < maxcount)
 		{
 		    for (i = 0; i < len; ++i)
 			if (opnd[i] != scan[i])
 			    break;
-		    if (i < len && (!ireg_ic || !enc_utf8
+		    if (i < len && (!rex->reg_ic || !enc_utf8
 					|| utf_fold(utf_ptr2char(scan)) != cf))
 			break;
 		    scan += len;
@@ -5622,27 +5857,28 @@ do_class:
 #endif
 	    if (*scan == NUL)
 	    {
-		if (!REG_MULTI || !WITH_NL(OP(p)) || reglnum > reg_maxline
-							      || reg_line_lbr)
+		if (!REG_MULTI || !WITH_NL(OP(p))
+			|| rex->lnum > rex->reg_maxline || rex->reg_line_lbr)
 		    break;
-		reg_nextline();
-		scan = reginput;
+		reg_nextline(rex);
+		scan = rex->input;
 		if (got_int)
 		    break;
 	    }
-	    else if (reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
+	    else if (rex->reg_line_lbr && *scan == '\n' && WITH_NL(OP(p)))
 		++scan;
 #ifdef FEAT_MBYTE
 	    else if (has_mbyte && (len = (*mb_ptr2len)(scan)) > 1)
 	    {
-		if ((cstrchr(opnd, (*mb_ptr2char)(scan)) == NULL) == testval)
+		if ((cstrchr(rex, opnd, (*mb_ptr2char)(scan)) == NULL)
+								   == testval)
 		    break;
 		scan += len;
 	    }
 #endif
 	    else
 	    {
-		if ((cstrchr(opnd, *scan) == NULL) == testval)
+		if ((cstrchr(rex, opnd, *scan) == NULL) == testval)
 		    break;
 		++scan;
 	    }
@@ -5652,15 +5888,16 @@ do_class:
 
       case NEWL:
 	while (count < maxcount
-		&& ((*scan == NUL && reglnum <= reg_maxline && !reg_line_lbr
-			    && REG_MULTI) || (*scan == '\n' && reg_line_lbr)))
+		&& ((*scan == NUL && rex->lnum <= rex->reg_maxline
+					  && !rex->reg_line_lbr && REG_MULTI)
+			    || (*scan == '\n' && rex->reg_line_lbr)))
 	{
 	    count++;
-	    if (reg_line_lbr)
+	    if (rex->reg_line_lbr)
 		ADVANCE_REGINPUT();
 	    else
-		reg_nextline();
-	    scan = reginput;
+		reg_nextline(rex);
+	    scan = rex->input;
 	    if (got_int)
 		break;
 	}
@@ -5674,7 +5911,7 @@ do_class:
 	break;
     }
 
-    reginput = scan;
+    rex->input = scan;
 
     return (int)count;
 }
@@ -5706,11 +5943,12 @@ regnext(p)
  * Return TRUE if it's wrong.
  */
     static int
-prog_magic_wrong()
+prog_magic_wrong(rex)
+    regexec_T	*rex;
 {
     if (UCHARAT(REG_MULTI
-		? reg_mmatch->regprog->program
-		: reg_match->regprog->program) != REGMAGIC)
+		? rex->reg_mmatch->regprog->program
+		: rex->reg_match->regprog->program) != REGMAGIC)
     {
 	EMSG(_(e_re_corr));
 	return TRUE;
@@ -5724,55 +5962,58 @@ prog_magic_wrong()
  * used (to increase speed).
  */
     static void
-cleanup_subexpr()
+cleanup_subexpr(rex)
+    regexec_T	*rex;
 {
-    if (need_clear_subexpr)
+    if (rex->need_clear_subexpr)
     {
 	if (REG_MULTI)
 	{
 	    /* Use 0xff to set lnum to -1 */
-	    vim_memset(reg_startpos, 0xff, sizeof(lpos_T) * NSUBEXP);
-	    vim_memset(reg_endpos, 0xff, sizeof(lpos_T) * NSUBEXP);
+	    vim_memset(rex->reg_startpos, 0xff, sizeof(lpos_T) * NSUBEXP);
+	    vim_memset(rex->reg_endpos, 0xff, sizeof(lpos_T) * NSUBEXP);
 	}
 	else
 	{
-	    vim_memset(reg_startp, 0, sizeof(char_u *) * NSUBEXP);
-	    vim_memset(reg_endp, 0, sizeof(char_u *) * NSUBEXP);
+	    vim_memset(rex->reg_startp, 0, sizeof(char_u *) * NSUBEXP);
+	    vim_memset(rex->reg_endp, 0, sizeof(char_u *) * NSUBEXP);
 	}
-	need_clear_subexpr = FALSE;
+	rex->need_clear_subexpr = FALSE;
     }
 }
 
 #ifdef FEAT_SYN_HL
     static void
-cleanup_zsubexpr()
+cleanup_zsubexpr(rex)
+    regexec_T	*rex;
 {
-    if (need_clear_zsubexpr)
+    if (rex->need_clear_zsubexpr)
     {
 	if (REG_MULTI)
 	{
 	    /* Use 0xff to set lnum to -1 */
-	    vim_memset(reg_startzpos, 0xff, sizeof(lpos_T) * NSUBEXP);
-	    vim_memset(reg_endzpos, 0xff, sizeof(lpos_T) * NSUBEXP);
+	    vim_memset(rex->reg_startzpos, 0xff, sizeof(lpos_T) * NSUBEXP);
+	    vim_memset(rex->reg_endzpos, 0xff, sizeof(lpos_T) * NSUBEXP);
 	}
 	else
 	{
-	    vim_memset(reg_startzp, 0, sizeof(char_u *) * NSUBEXP);
-	    vim_memset(reg_endzp, 0, sizeof(char_u *) * NSUBEXP);
+	    vim_memset(rex->reg_startzp, 0, sizeof(char_u *) * NSUBEXP);
+	    vim_memset(rex->reg_endzp, 0, sizeof(char_u *) * NSUBEXP);
 	}
-	need_clear_zsubexpr = FALSE;
+	rex->need_clear_zsubexpr = FALSE;
     }
 }
 #endif
 
 /*
- * Advance reglnum, regline and reginput to the next line.
+ * Advance rex->lnum, rex->line and rex->input to the next line.
  */
     static void
-reg_nextline()
+reg_nextline(rex)
+    regexec_T	*rex;
 {
-    regline = reg_getline(++reglnum);
-    reginput = regline;
+    rex->line = reg_getline(rex, ++rex->lnum);
+    rex->input = rex->line;
     fast_breakcheck();
 }
 
@@ -5780,17 +6021,18 @@ reg_nextline()
  * Save the input line and position in a regsave_T.
  */
     static void
-reg_save(save, gap)
+reg_save(rex, save, gap)
+    regexec_T	*rex;
     regsave_T	*save;
     garray_T	*gap;
 {
     if (REG_MULTI)
     {
-	save->rs_u.pos.col = (colnr_T)(reginput - regline);
-	save->rs_u.pos.lnum = reglnum;
+	save->rs_u.pos.col = (colnr_T)(rex->input - rex->line);
+	save->rs_u.pos.lnum = rex->lnum;
     }
     else
-	save->rs_u.ptr = reginput;
+	save->rs_u.ptr = rex->input;
     save->rs_len = gap->ga_len;
 }
 
@@ -5798,23 +6040,24 @@ reg_save(save, gap)
  * Restore the input line and position from a regsave_T.
  */
     static void
-reg_restore(save, gap)
+reg_restore(rex, save, gap)
+    regexec_T	*rex;
     regsave_T	*save;
     garray_T	*gap;
 {
     if (REG_MULTI)
     {
-	if (reglnum != save->rs_u.pos.lnum)
+	if (rex->lnum != save->rs_u.pos.lnum)
 	{
 	    /* only call reg_getline() when the line number changed to save
 	     * a bit of time */
-	    reglnum = save->rs_u.pos.lnum;
-	    regline = reg_getline(reglnum);
+	    rex->lnum = save->rs_u.pos.lnum;
+	    rex->line = reg_getline(rex, rex->lnum);
 	}
-	reginput = regline + save->rs_u.pos.col;
+	rex->input = rex->line + save->rs_u.pos.col;
     }
     else
-	reginput = save->rs_u.ptr;
+	rex->input = save->rs_u.ptr;
     gap->ga_len = save->rs_len;
 }
 
@@ -5822,13 +6065,14 @@ reg_restore(save, gap)
  * Return TRUE if current position is equal to saved position.
  */
     static int
-reg_save_equal(save)
+reg_save_equal(rex, save)
+    regexec_T	*rex;
     regsave_T	*save;
 {
     if (REG_MULTI)
-	return reglnum == save->rs_u.pos.lnum
-				  && reginput == regline + save->rs_u.pos.col;
-    return reginput == save->rs_u.ptr;
+	return rex->lnum == save->rs_u.pos.lnum
+			     && rex->input == rex->line + save->rs_u.pos.col;
+    return rex->input == save->rs_u.ptr;
 }
 
 /*
@@ -5839,22 +6083,24 @@ reg_save_equal(save)
  * depending on REG_MULTI.
  */
     static void
-save_se_multi(savep, posp)
+save_se_multi(rex, savep, posp)
+    regexec_T	*rex;
     save_se_T	*savep;
     lpos_T	*posp;
 {
     savep->se_u.pos = *posp;
-    posp->lnum = reglnum;
-    posp->col = (colnr_T)(reginput - regline);
+    posp->lnum = rex->lnum;
+    posp->col = (colnr_T)(rex->input - rex->line);
 }
 
     static void
-save_se_one(savep, pp)
+save_se_one(rex, savep, pp)
+    regexec_T	*rex;
     save_se_T	*savep;
     char_u	**pp;
 {
     savep->se_u.ptr = *pp;
-    *pp = reginput;
+    *pp = rex->input;
 }
 
 /*
@@ -6407,25 +6653,26 @@ mb_decompose(c, c1, c2, c3)
 #endif
 
 /*
- * Compare two strings, ignore case if ireg_ic set.
+ * Compare two strings, ignore case if reg_ic set.
  * Return 0 if strings match, non-zero otherwise.
  * Correct the length "*n" when composing characters are ignored.
  */
     static int
-cstrncmp(s1, s2, n)
+cstrncmp(rex, s1, s2, n)
+    regexec_T	*rex;
     char_u	*s1, *s2;
     int		*n;
 {
     int		result;
 
-    if (!ireg_ic)
+    if (!rex->reg_ic)
 	result = STRNCMP(s1, s2, *n);
     else
 	result = MB_STRNICMP(s1, s2, *n);
 
 #ifdef FEAT_MBYTE
     /* if it failed and it's utf8 and we want to combineignore: */
-    if (result != 0 && enc_utf8 && ireg_icombine)
+    if (result != 0 && enc_utf8 && rex->reg_icombine)
     {
 	char_u	*str1, *str2;
 	int	c1, c2, c11, c12;
@@ -6444,14 +6691,15 @@ cstrncmp(s1, s2, n)
 	    /* decompose the character if necessary, into 'base' characters
 	     * because I don't care about Arabic, I will hard-code the Hebrew
 	     * which I *do* care about!  So sue me... */
-	    if (c1 != c2 && (!ireg_ic || utf_fold(c1) != utf_fold(c2)))
+	    if (c1 != c2 && (!rex->reg_ic || utf_fold(c1) != utf_fold(c2)))
 	    {
 		/* decomposition necessary? */
 		mb_decompose(c1, &c11, &junk, &junk);
 		mb_decompose(c2, &c12, &junk, &junk);
 		c1 = c11;
 		c2 = c12;
-		if (c11 != c12 && (!ireg_ic || utf_fold(c11) != utf_fold(c12)))
+		if (c11 != c12
+			&& (!rex->reg_ic || utf_fold(c11) != utf_fold(c12)))
 		    break;
 	    }
 	}
@@ -6468,14 +6716,15 @@ cstrncmp(s1, s2, n)
  * cstrchr: This function is used a lot for simple searches, keep it fast!
  */
     static char_u *
-cstrchr(s, c)
+cstrchr(rex, s, c)
+    regexec_T	*rex;
     char_u	*s;
     int		c;
 {
     char_u	*p;
     int		cc;
 
-    if (!ireg_ic
+    if (!rex->reg_ic
 #ifdef FEAT_MBYTE
 	    || (!enc_utf8 && mb_char2len(c) > 1)
 #endif
@@ -6544,7 +6793,8 @@ static fptr_T do_Upper __ARGS((int *, int));
 static fptr_T do_lower __ARGS((int *, int));
 static fptr_T do_Lower __ARGS((int *, int));
 
-static int vim_regsub_both __ARGS((char_u *source, char_u *dest, int copy, int magic, int backslash));
+static int vim_regsub_both __ARGS((regexec_T *rex, char_u *source,
+			  char_u *dest, int copy, int magic, int backslash));
 
     static fptr_T
 do_upper(d, c)
@@ -6664,11 +6914,10 @@ regtilde(source, magic)
 #ifdef FEAT_EVAL
 static int can_f_submatch = FALSE;	/* TRUE when submatch() can be used */
 
-/* These pointers are used instead of reg_match and reg_mmatch for
- * reg_submatch().  Needed for when the substitution string is an expression
- * that contains a call to substitute() and submatch(). */
-static regmatch_T	*submatch_match;
-static regmmatch_T	*submatch_mmatch;
+/* The context of the ":s" match, used by reg_submatch().  Needed for when
+ * the substitution string is an expression that contains a call to
+ * substitute() and submatch(). */
+static regexec_T	*submatch_rex;
 #endif
 
 #if defined(FEAT_MODIFY_FNAME) || defined(FEAT_EVAL) || defined(PROTO)
@@ -6699,10 +6948,11 @@ vim_regsub(rmp, source, dest, copy, magic, backslash)
     int		magic;
     int		backslash;
 {
-    reg_match = rmp;
-    reg_mmatch = NULL;
-    reg_maxline = 0;
-    return vim_regsub_both(source, dest, copy, magic, backslash);
+    regexec_T	rex;
+
+    reg_exec_init(&rex);
+    rex.reg_match = rmp;
+    return vim_regsub_both(&rex, source, dest, copy, magic, backslash);
 }
 #endif
 
@@ -6716,16 +6966,19 @@ vim_regsub_multi(rmp, lnum, source, dest, copy, magic, backslash)
     int		magic;
     int		backslash;
 {
-    reg_match = NULL;
-    reg_mmatch = rmp;
-    reg_buf = curbuf;		/* always works on the current buffer! */
-    reg_firstlnum = lnum;
-    reg_maxline = curbuf->b_ml.ml_line_count - lnum;
-    return vim_regsub_both(source, dest, copy, magic, backslash);
+    regexec_T	rex;
+
+    reg_exec_init(&rex);
+    rex.reg_mmatch = rmp;
+    rex.reg_buf = curbuf;	/* always works on the current buffer! */
+    rex.reg_firstlnum = lnum;
+    rex.reg_maxline = curbuf->b_ml.ml_line_count - lnum;
+    return vim_regsub_both(&rex, source, dest, copy, magic, backslash);
 }
 
     static int
-vim_regsub_both(source, dest, copy, magic, backslash)
+vim_regsub_both(rex, source, dest, copy, magic, backslash)
+    regexec_T	*rex;
     char_u	*source;
     char_u	*dest;
     int		copy;
@@ -6751,7 +7004,7 @@ vim_regsub_both(source, dest, copy, magic, backslash)
 	EMSG(_(e_null));
 	return 0;
     }
-    if (prog_magic_wrong())
+    if (prog_magic_wrong(rex))
 	return 0;
     src = source;
     dst = dest;
@@ -6782,21 +7035,12 @@ vim_regsub_both(source, dest, copy, magic, backslash)
 	}
 	else
 	{
-	    linenr_T	save_reg_maxline;
-	    win_T	*save_reg_win;
-	    int		save_ireg_ic;
-
 	    vim_free(eval_result);
 
 	    /* The expression may contain substitute(), which calls us
-	     * recursively.  Make sure submatch() gets the text from the first
-	     * level.  Don't need to save "reg_buf", because
-	     * vim_regexec_multi() can't be called recursively. */
-	    submatch_match = reg_match;
-	    submatch_mmatch = reg_mmatch;
-	    save_reg_maxline = reg_maxline;
-	    save_reg_win = reg_win;
-	    save_ireg_ic = ireg_ic;
+	     * recursively.  That uses its own context, make sure submatch()
+	     * gets the text from the first level. */
+	    submatch_rex = rex;
 	    can_f_submatch = TRUE;
 
 	    eval_result = eval_to_string(source + 2, NULL, TRUE);
@@ -6815,11 +7059,7 @@ vim_regsub_both(source, dest, copy, magic, backslash)
 		dst += STRLEN(eval_result);
 	    }
 
-	    reg_match = submatch_match;
-	    reg_mmatch = submatch_mmatch;
-	    reg_maxline = save_reg_maxline;
-	    reg_win = save_reg_win;
-	    ireg_ic = save_ireg_ic;
+	    submatch_rex = NULL;
 	    can_f_submatch = FALSE;
 	}
 #endif
@@ -6930,26 +7170,27 @@ vim_regsub_both(source, dest, copy, magic, backslash)
 	{
 	    if (REG_MULTI)
 	    {
-		clnum = reg_mmatch->startpos[no].lnum;
-		if (clnum < 0 || reg_mmatch->endpos[no].lnum < 0)
+		clnum = rex->reg_mmatch->startpos[no].lnum;
+		if (clnum < 0 || rex->reg_mmatch->endpos[no].lnum < 0)
 		    s = NULL;
 		else
 		{
-		    s = reg_getline(clnum) + reg_mmatch->startpos[no].col;
-		    if (reg_mmatch->endpos[no].lnum == clnum)
-			len = reg_mmatch->endpos[no].col
-					       - reg_mmatch->startpos[no].col;
+		    s = reg_getline(rex, clnum)
+					 + rex->reg_mmatch->startpos[no].col;
+		    if (rex->reg_mmatch->endpos[no].lnum == clnum)
+			len = rex->reg_mmatch->endpos[no].col
+					  - rex->reg_mmatch->startpos[no].col;
 		    else
 			len = (int)STRLEN(s);
 		}
 	    }
 	    else
 	    {
-		s = reg_match->startp[no];
-		if (reg_match->endp[no] == NULL)
+		s = rex->reg_match->startp[no];
+		if (rex->reg_match->endp[no] == NULL)
 		    s = NULL;
 		else
-		    len = (int)(reg_match->endp[no] - s);
+		    len = (int)(rex->reg_match->endp[no] - s);
 	    }
 	    if (s != NULL)
 	    {
@@ -6959,14 +7200,14 @@ vim_regsub_both(source, dest, copy, magic, backslash)
 		    {
 			if (REG_MULTI)
 			{
-			    if (reg_mmatch->endpos[no].lnum == clnum)
+			    if (rex->reg_mmatch->endpos[no].lnum == clnum)
 				break;
 			    if (copy)
 				*dst = CAR;
 			    ++dst;
-			    s = reg_getline(++clnum);
-			    if (reg_mmatch->endpos[no].lnum == clnum)
-				len = reg_mmatch->endpos[no].col;
+			    s = reg_getline(rex, ++clnum);
+			    if (rex->reg_mmatch->endpos[no].lnum == clnum)
+				len = rex->reg_mmatch->endpos[no].col;
 			    else
 				len = (int)STRLEN(s);
 			}
@@ -7059,9 +7300,13 @@ reg_submatch(no)
     int		len;
     int		round;
     linenr_T	lnum;
+    regmatch_T	*submatch_match;
+    regmmatch_T	*submatch_mmatch;
 
     if (!can_f_submatch || no < 0)
 	return NULL;
+    submatch_match = submatch_rex->reg_match;
+    submatch_mmatch = submatch_rex->reg_mmatch;
 
     if (submatch_match == NULL)
     {
@@ -7075,7 +7320,8 @@ reg_submatch(no)
 	    if (lnum < 0 || submatch_mmatch->endpos[no].lnum < 0)
 		return NULL;
 
-	    s = reg_getline(lnum) + submatch_mmatch->startpos[no].col;
+	    s = reg_getline(submatch_rex, lnum)
+					 + submatch_mmatch->startpos[no].col;
 	    if (s == NULL)  /* anti-crash check, cannot happen? */
 		break;
 	    if (submatch_mmatch->endpos[no].lnum == lnum)
@@ -7101,7 +7347,7 @@ reg_submatch(no)
 		++lnum;
 		while (lnum < submatch_mmatch->endpos[no].lnum)
 		{
-		    s = reg_getline(lnum++);
+		    s = reg_getline(submatch_rex, lnum++);
 		    if (round == 2)
 			STRCPY(retval + len, s);
 		    len += (int)STRLEN(s);
@@ -7110,7 +7356,7 @@ reg_submatch(no)
 		    ++len;
 		}
 		if (round == 2)
-		    STRNCPY(retval + len, reg_getline(lnum),
+		    STRNCPY(retval + len, reg_getline(submatch_rex, lnum),
 					     submatch_mmatch->endpos[no].col);
 		len += submatch_mmatch->endpos[no].col;
 		if (round == 2)
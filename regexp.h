@@ -67,6 +67,21 @@ typedef struct
     colnr_T		rmm_maxcol;	/* when not zero: maximum column */
 } regmmatch_T;
 
+/*
+ * Limit for executing regexps, see regbudget_init().  One budget can be used
+ * for many calls, e.g. for all the matching done while redrawing.
+ * Without the +reltime feature the time is estimated by counting steps.
+ */
+typedef struct
+{
+    long		rb_steps;	/* nr of steps done so far */
+    long		rb_maxsteps;	/* when not zero: maximum nr of steps */
+#ifdef FEAT_RELTIME
+    proftime_T		rb_deadline;	/* when set: stop after this time */
+#endif
+    int			rb_timed_out;	/* budget was used up */
+} regbudget_T;
+
 /*
  * Structure used to store external references: "\z\(\)" to "\z\1".
  * Use a reference count to avoid the need to copy this around.  When it goes
@@ -0,0 +1,718 @@
+/* vi:set ts=8 sts=4 sw=4:
+ *
+ * VIM - Vi IMproved	by Bram Moolenaar
+ *
+ * Do ":help uganda"  in Vim to read copying and usage conditions.
+ * Do ":help credits" in Vim to see a list of people who contributed.
+ */
+
+/*
+ * regtest.c: Benchmark and differential fuzzer for the regexp engine.
+ *
+ * This is linked with regexp.c, mbyte.c, charset.c and shim.c only, see the
+ * "regtest" target in the mkfile.
+ *
+ * regtest [-u] [-n lines] [file ..]
+ *	Benchmark: match a set of patterns, taken from the syntax files and
+ *	from common searches, against the lines of the files, or against
+ *	generated C-like text when there are no files.  For each pattern the
+ *	time used per line is reported, both for calling vim_regexec_multi()
+ *	on every line (like 'hlsearch' and syntax highlighting do) and for
+ *	scanning with vim_regexec_lines() (like ":g" and "n" do).
+ *
+ * regtest -f [-u] [-v] [-s seed] [-c count]
+ *	Fuzzer: generate random patterns and text and check that matching
+ *	gives the same result in different ways:
+ *	- with and without the regstart, regmust and reganch optimizations
+ *	- vim_regexec_multi() on each line and vim_regexec_lines() over all
+ *	  lines
+ *	- vim_regexec_multi() and vim_regexec() on a single line, when the
+ *	  pattern can't match a line break
+ *	All of this is done with and without ignoring case.  Patterns that are
+ *	invalid or take too long are skipped.  The exit status is non-zero
+ *	when a difference was found.
+ *
+ * -u uses 'encoding' "utf-8" instead of "latin1".
+ */
+
+#include "vim.h"
+#include <time.h>
+
+void shim_init __ARGS((int utf8, int verbose));
+void shim_set_lines __ARGS((char_u **lines, long count));
+
+static unsigned long rnd_seed = 1;
+static unsigned long case_seed;	/* "rnd_seed" at the start of a test */
+
+static int rnd __ARGS((int n));
+static void usage __ARGS((void));
+static char_u **read_lines __ARGS((int argc, char **argv, long *countp));
+static char_u **gen_lines __ARGS((long count));
+static double ns_per_line __ARGS((clock_t start, long reps, long count));
+static void bench_pat __ARGS((char *pat, long count));
+static void bench __ARGS((char_u **lines, long count));
+static void gen_atom __ARGS((garray_T *gap, int depth));
+static void gen_pat __ARGS((garray_T *gap, int depth));
+static void gen_text __ARGS((char_u **lines, int count));
+static void copy_single __ARGS((regmatch_T *rm, char_u *line,
+							    regmmatch_T *out));
+static int same_match __ARGS((long r1, regmmatch_T *m1, long r2,
+							     regmmatch_T *m2));
+static void report __ARGS((char *what, char_u *pat, int ic, char_u **lines,
+		int count, linenr_T lnum, long r1, regmmatch_T *m1, long r2,
+							     regmmatch_T *m2));
+static int fuzz_one __ARGS((char_u *pat, int ic, char_u **lines, int count));
+static int fuzz __ARGS((long count));
+
+/*
+ * Pseudo random number from 0 to "n" - 1.  Not using rand(), so that a seed
+ * gives the same patterns on every system.
+ */
+    static int
+rnd(n)
+    int		n;
+{
+    rnd_seed = rnd_seed * 1103515245L + 12345L;
+    return (int)((rnd_seed >> 16) & 0x7fff) % n;
+}
+
+    static void
+usage()
+{
+    fprintf(stderr, "usage: regtest [-u] [-n lines] [file ..]\n");
+    fprintf(stderr, "       regtest -f [-u] [-v] [-s seed] [-c count]\n");
+    exit(2);
+}
+
+/*
+ * Read all lines of the files "argv[argc]".  Returns the array of lines and
+ * stores the number of lines in "*countp".
+ */
+    static char_u **
+read_lines(argc, argv, countp)
+    int		argc;
+    char	**argv;
+    long	*countp;
+{
+    garray_T	ga;
+    char	buf[IOSIZE];
+    FILE	*fd;
+    int		len;
+    int		i;
+
+    ga_init2(&ga, (int)sizeof(char_u *), 1000);
+    for (i = 0; i < argc; ++i)
+    {
+	fd = fopen(argv[i], "r");
+	if (fd == NULL)
+	{
+	    fprintf(stderr, "regtest: cannot open %s\n", argv[i]);
+	    exit(2);
+	}
+	/* Long lines are split, that doesn't matter here. */
+	while (fgets(buf, IOSIZE, fd) != NULL)
+	{
+	    len = (int)STRLEN(buf);
+	    if (len > 0 && buf[len - 1] == '\n')
+		buf[--len] = NUL;
+	    if (ga_grow(&ga, 1) == FAIL)
+		exit(2);
+	    ((char_u **)ga.ga_data)[ga.ga_len++] =
+					   vim_strnsave((char_u *)buf, len);
+	}
+	fclose(fd);
+    }
+    *countp = ga.ga_len;
+    return (char_u **)ga.ga_data;
+}
+
+/*
+ * Generate "count" lines that look a bit like C code.
+ */
+    static char_u **
+gen_lines(count)
+    long	count;
+{
+    static char *words[] = {
+	"int", "char_u", "*p", "=", "==", "(", ")", "{", "}", ";", "if",
+	"while", "for", "return", "0x1f", "123", "3.14", "\"string\"",
+	"'c'", "/* comment */", "// note", "foo_bar", "TRUE", "NULL",
+	"vim_free(p);", "curwin->w_cursor.lnum", "#include", "<stdio.h>",
+	"buf[i]", "+=", "TODO", "MAXCOL", "static", "\\n", "x", "alpha"};
+    char_u	**lines;
+    char_u	buf[200];
+    long	i;
+    int		n;
+    int		len;
+    char	*w;
+
+    lines = (char_u **)alloc((unsigned)(count * sizeof(char_u *)));
+    if (lines == NULL)
+	exit(2);
+    for (i = 0; i < count; ++i)
+    {
+	len = 0;
+	for (n = rnd(4); n > 0; --n)
+	    buf[len++] = TAB;
+	for (n = rnd(12); n > 0; --n)
+	{
+	    w = words[rnd((int)(sizeof(words) / sizeof(char *)))];
+	    if (len + (int)STRLEN(w) + 2 >= (int)sizeof(buf))
+		break;
+	    STRCPY(buf + len, w);
+	    len += (int)STRLEN(w);
+	    buf[len++] = ' ';
+	}
+	/* Mostly without trailing white space. */
+	if (len > 0 && rnd(10) > 0)
+	    --len;
+	lines[i] = vim_strnsave(buf, len);
+    }
+    return lines;
+}
+
+/*
+ * Benchmark patterns.  Most are from the syntax files for C and Vim, the rest
+ * are typical searches.
+ */
+static char *bench_pats[] = {
+    "foo_bar",
+    "\\<int\\>",
+    "\\<\\(if\\|while\\|for\\|return\\)\\>",
+    "\\cnull",
+    "\\s\\+$",
+    "^\\s*#\\s*include\\>",
+    "\\d\\+\\(u\\=l\\{0,2}\\|ll\\=u\\)\\>",
+    "0x\\x\\+\\(u\\=l\\{0,2}\\|ll\\=u\\)\\>",
+    "\\(\\d\\+\\.\\d*\\|\\.\\d\\+\\)\\(e[-+]\\=\\d\\+\\)\\=[fl]\\=",
+    "L\\=\"\\([^\"\\\\]\\|\\\\.\\)*\"",
+    "L\\='[^\\\\]'",
+    "/\\*.\\{-}\\*/",
+    "//.*",
+    "\\<\\h\\w*\\ze\\s*(",
+    "[{}]",
+    "\\<\\u\\+\\>",
+    "\\(TODO\\|FIXME\\|XXX\\)",
+    "[a-z]\\+_[a-z]\\+",
+    "\\v<(\\w+)-\\>(\\w+)>",
+    "\\%(\\w\\+\\s*=\\)\\@<=\\s*\\d",
+    "\\S\\@<=\\s\\+\\S\\@=",
+    ".*x$",
+    "^\\s*\\(\\h\\w*\\s\\+\\)*\\h\\w*\\s*(",
+    "\\_s\\+return",
+    NULL
+};
+
+    static double
+ns_per_line(start, reps, count)
+    clock_t	start;
+    long	reps;
+    long	count;
+{
+    return (double)(clock() - start) * 1.0e9 / (double)CLOCKS_PER_SEC
+					     / (double)reps / (double)count;
+}
+
+/*
+ * Benchmark one pattern against the "count" lines of the buffer.  Each way
+ * of matching is repeated until it took a quarter of a second.
+ */
+    static void
+bench_pat(pat, count)
+    char	*pat;
+    long	count;
+{
+    regmmatch_T	regmatch;
+    clock_t	start;
+    long	reps;
+    long	matches = 0;
+    double	t_line;
+    double	t_scan;
+    linenr_T	lnum;
+    long	nmatched;
+
+    /* An error, e.g. for 'maxmempattern', sets got_int. */
+    got_int = FALSE;
+    called_emsg = FALSE;
+    regmatch.regprog = vim_regcomp((char_u *)pat, RE_MAGIC);
+    if (regmatch.regprog == NULL)
+    {
+	printf("%-40s  invalid pattern\n", pat);
+	return;
+    }
+    regmatch.rmm_ic = FALSE;
+    regmatch.rmm_maxcol = 0;
+
+    start = clock();
+    for (reps = 1; ; ++reps)
+    {
+	matches = 0;
+	for (lnum = 1; lnum <= count; ++lnum)
+	    if (vim_regexec_multi(&regmatch, curwin, curbuf, lnum, (colnr_T)0,
+								 NULL) > 0)
+		++matches;
+	if (clock() - start >= CLOCKS_PER_SEC / 4)
+	    break;
+    }
+    t_line = ns_per_line(start, reps, count);
+
+    start = clock();
+    for (reps = 1; ; ++reps)
+    {
+	for (lnum = 1; lnum <= count; ++lnum)
+	{
+	    lnum = vim_regexec_lines(&regmatch, curwin, curbuf, lnum,
+				      (linenr_T)count, &nmatched, NULL);
+	    if (lnum == 0)
+		break;
+	}
+	if (clock() - start >= CLOCKS_PER_SEC / 4)
+	    break;
+    }
+    t_scan = ns_per_line(start, reps, count);
+
+    if (called_emsg)
+	printf("%-40s  error while matching\n", pat);
+    else
+	printf("%-40s %8ld %10.0f %10.0f\n", pat, matches, t_line, t_scan);
+    vim_free(regmatch.regprog);
+}
+
+    static void
+bench(lines, count)
+    char_u	**lines;
+    long	count;
+{
+    int		i;
+
+    shim_set_lines(lines, count);
+    printf("%ld lines, 'encoding' %s\n", count, p_enc);
+    printf("%-40s %8s %10s %10s\n", "pattern", "matches", "ns/line",
+								 "scan ns");
+    for (i = 0; bench_pats[i] != NULL; ++i)
+	bench_pat(bench_pats[i], count);
+}
+
+/*
+ * Pieces for generated patterns and text.  The text uses only a few
+ * characters, so that the patterns have a reasonable chance of matching.
+ * The non-ASCII characters are filled in depending on 'encoding'.
+ */
+static char *fuzz_atoms[] = {
+    "a", "b", "c", " ", "ab", "ba", "A", "B", "\\t", ".", "\\w", "\\W",
+    "\\s", "\\S", "\\a", "\\u", "\\l", "\\d", "[ab]", "[^a]", "[a-c]",
+    "[[:space:]]", "[[:upper:]]", "\\<", "\\>", "^", "$", "\\n", "\\_s",
+    "\\_.", "\\_[ab]", "\\zs", "\\ze", "\\%[ab]", "\\1", "\\e", "x"};
+static char *fuzz_multis[] = {
+    "*", "\\+", "\\=", "\\?", "\\{2}", "\\{1,3}", "\\{-}", "\\{-1,}",
+    "\\{,2}", "\\@=", "\\@!", "\\@<=", "\\@<!", "\\@>"};
+static char *fuzz_chars = "aabbc  AB\t";
+static char_u fuzz_lower[5];		/* a non-ASCII lower case character */
+static char_u fuzz_upper[5];		/* its upper case version */
+
+#define FUZZ_ATOMS (int)(sizeof(fuzz_atoms) / sizeof(char *))
+#define FUZZ_MULTIS (int)(sizeof(fuzz_multis) / sizeof(char *))
+#define FUZZ_MAXLINES	4	/* maximum number of lines of text */
+#define FUZZ_MAXLEN	14	/* maximum length of a line of text */
+
+/*
+ * Append a random atom, possibly followed by a multi, to "gap".
+ */
+    static void
+gen_atom(gap, depth)
+    garray_T	*gap;
+    int		depth;
+{
+    int		n = rnd(12);
+    int		start = gap->ga_len;
+    char	*multi;
+
+    if (depth < 3 && n == 0)
+    {
+	ga_concat(gap, (char_u *)(rnd(3) == 0 ? "\\%(" : "\\("));
+	gen_pat(gap, depth + 1);
+	ga_concat(gap, (char_u *)"\\)");
+    }
+    else if (n == 1)
+	ga_concat(gap, rnd(2) ? fuzz_lower : fuzz_upper);
+    else
+	ga_concat(gap, (char_u *)fuzz_atoms[rnd(FUZZ_ATOMS)]);
+    if (rnd(3) == 0)
+    {
+	multi = fuzz_multis[rnd(FUZZ_MULTIS)];
+	/* The match end and sub-matches set inside a look-behind are not
+	 * reset when it fails, the result then depends on how the text was
+	 * searched.  Avoid that known problem. */
+	if (STRNCMP(multi, "\\@<", 3) == 0)
+	{
+	    ga_append(gap, NUL);
+	    --gap->ga_len;
+	    if (strstr((char *)gap->ga_data + start, "\\z") != NULL
+		    || strstr((char *)gap->ga_data + start, "\\(") != NULL)
+		return;
+	}
+	ga_concat(gap, (char_u *)multi);
+    }
+}
+
+/*
+ * Append a random pattern with one or two branches to "gap".
+ */
+    static void
+gen_pat(gap, depth)
+    garray_T	*gap;
+    int		depth;
+{
+    int		branches = rnd(4) == 0 ? 2 : 1;
+    int		n;
+
+    while (branches-- > 0)
+    {
+	for (n = rnd(4) + 1; n > 0; --n)
+	    gen_atom(gap, depth);
+	if (branches > 0)
+	    ga_concat(gap, (char_u *)(rnd(4) == 0 ? "\\&" : "\\|"));
+    }
+}
+
+/*
+ * Fill "lines[count]" with random text.
+ */
+    static void
+gen_text(lines, count)
+    char_u	**lines;
+    int		count;
+{
+    int		i;
+    int		n;
+    char_u	*p;
+
+    for (i = 0; i < count; ++i)
+    {
+	p = lines[i];
+	for (n = rnd(FUZZ_MAXLEN); n > 0; --n)
+	{
+	    if (rnd(8) == 0)
+	    {
+		STRCPY(p, rnd(2) ? fuzz_lower : fuzz_upper);
+		p += STRLEN(p);
+	    }
+	    else
+		*p++ = fuzz_chars[rnd((int)STRLEN(fuzz_chars))];
+	}
+	*p = NUL;
+    }
+}
+
+/*
+ * Convert the result of single-line matching "rm" in "line" to the form of
+ * multi-line matching.
+ */
+    static void
+copy_single(rm, line, out)
+    regmatch_T	*rm;
+    char_u	*line;
+    regmmatch_T	*out;
+{
+    int		i;
+
+    for (i = 0; i < NSUBEXP; ++i)
+    {
+	if (rm->startp[i] == NULL)
+	    out->startpos[i].lnum = -1;
+	else
+	{
+	    out->startpos[i].lnum = 0;
+	    out->startpos[i].col = (colnr_T)(rm->startp[i] - line);
+	}
+	if (rm->endp[i] == NULL)
+	    out->endpos[i].lnum = -1;
+	else
+	{
+	    out->endpos[i].lnum = 0;
+	    out->endpos[i].col = (colnr_T)(rm->endp[i] - line);
+	}
+    }
+}
+
+/*
+ * Return TRUE when two results of matching are the same.
+ */
+    static int
+same_match(r1, m1, r2, m2)
+    long	r1;
+    regmmatch_T	*m1;
+    long	r2;
+    regmmatch_T	*m2;
+{
+    int		i;
+
+    if (r1 != r2)
+	return FALSE;
+    if (r1 == 0)
+	return TRUE;
+    for (i = 0; i < NSUBEXP; ++i)
+    {
+	if (m1->startpos[i].lnum != m2->startpos[i].lnum
+		|| m1->endpos[i].lnum != m2->endpos[i].lnum)
+	    return FALSE;
+	if (m1->startpos[i].lnum >= 0
+		&& m1->startpos[i].col != m2->startpos[i].col)
+	    return FALSE;
+	if (m1->endpos[i].lnum >= 0
+		&& m1->endpos[i].col != m2->endpos[i].col)
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+    static void
+report(what, pat, ic, lines, count, lnum, r1, m1, r2, m2)
+    char	*what;
+    char_u	*pat;
+    int		ic;
+    char_u	**lines;
+    int		count;
+    linenr_T	lnum;
+    long	r1;
+    regmmatch_T	*m1;
+    long	r2;
+    regmmatch_T	*m2;
+{
+    int		i;
+
+    printf("MISMATCH (%s) seed %lu, 'encoding' %s, ic %d, line %ld\n",
+					     what, case_seed, p_enc, ic, lnum);
+    printf("  pattern: /%s/\n", pat);
+    for (i = 0; i < count; ++i)
+	printf("  %d: \"%s\"\n", i + 1, lines[i]);
+    printf("  result 1: %ld", r1);
+    if (r1 > 0)
+	printf(" (%ld, %d) - (%ld, %d)", m1->startpos[0].lnum,
+		m1->startpos[0].col, m1->endpos[0].lnum, m1->endpos[0].col);
+    printf("\n  result 2: %ld", r2);
+    if (r2 > 0)
+	printf(" (%ld, %d) - (%ld, %d)", m2->startpos[0].lnum,
+		m2->startpos[0].col, m2->endpos[0].lnum, m2->endpos[0].col);
+    printf("\n");
+}
+
+/*
+ * Check pattern "pat" against the text in "lines[count]".  Return the number
+ * of differences found.
+ */
+    static int
+fuzz_one(pat, ic, lines, count)
+    char_u	*pat;
+    int		ic;
+    char_u	**lines;
+    int		count;
+{
+    regmmatch_T	opt;		/* with the optimizations */
+    regmmatch_T	ref;		/* without the optimizations */
+    regmmatch_T	first;		/* first match found line by line */
+    regmmatch_T	single_m;
+    regmatch_T	single;
+    regbudget_T	budget;
+    long	r_opt;
+    long	r_ref;
+    long	r_first = 0;
+    long	r;
+    linenr_T	lnum;
+    linenr_T	lnum_first = 0;
+    int		timed_out = FALSE;
+    int		errors = 0;
+
+    got_int = FALSE;
+    called_emsg = FALSE;
+    opt.regprog = vim_regcomp(pat, RE_MAGIC);
+    ref.regprog = vim_regcomp(pat, RE_MAGIC);
+    if (opt.regprog == NULL || ref.regprog == NULL || called_emsg)
+	goto theend;
+    ref.regprog->regstart = NUL;
+    ref.regprog->reganch = 0;
+    ref.regprog->regmust = NULL;
+    ref.regprog->regmlen = 0;
+    opt.rmm_ic = ref.rmm_ic = ic;
+    opt.rmm_maxcol = ref.rmm_maxcol = 0;
+
+    for (lnum = 1; lnum <= count; ++lnum)
+    {
+	regbudget_init(&budget, 20L);
+	r_opt = vim_regexec_multi(&opt, curwin, curbuf, lnum, (colnr_T)0,
+								    &budget);
+	r_ref = vim_regexec_multi(&ref, curwin, curbuf, lnum, (colnr_T)0,
+								    &budget);
+	if (budget.rb_timed_out || called_emsg || got_int)
+	{
+	    timed_out = TRUE;
+	    break;
+	}
+	if (!same_match(r_opt, &opt, r_ref, &ref))
+	{
+	    report("optimized", pat, ic, lines, count, lnum,
+						   r_opt, &opt, r_ref, &ref);
+	    ++errors;
+	}
+	if (r_opt > 0 && lnum_first == 0)
+	{
+	    lnum_first = lnum;
+	    r_first = r_opt;
+	    first = opt;
+	}
+
+	/* Single-line matching can't see the following lines.  Before a
+	 * "\&" a line break may be matched without the pattern being
+	 * flagged as multi-line, thus skip those too. */
+	if (!re_multiline(opt.regprog)
+			    && strstr((char *)pat, "\\&") == NULL)
+	{
+	    single.regprog = opt.regprog;
+	    single.rm_ic = ic;
+	    r = vim_regexec(&single, lines[lnum - 1], (colnr_T)0);
+	    copy_single(&single, lines[lnum - 1], &single_m);
+	    if (!same_match(r_opt, &opt, r, &single_m))
+	    {
+		report("single-line", pat, ic, lines, count, lnum,
+						   r_opt, &opt, r, &single_m);
+		++errors;
+	    }
+	}
+    }
+
+    if (!timed_out)
+    {
+	regbudget_init(&budget, 20L);
+	lnum = vim_regexec_lines(&opt, curwin, curbuf, (linenr_T)1,
+					      (linenr_T)count, &r, &budget);
+	if (!budget.rb_timed_out && !called_emsg && !got_int)
+	{
+	    if (lnum != lnum_first)
+	    {
+		report("lines", pat, ic, lines, count, lnum_first,
+					     r_first, &first, r, &opt);
+		printf("  vim_regexec_lines() found line %ld\n", lnum);
+		++errors;
+	    }
+	    else if (lnum > 0 && !same_match(r_first, &first, r, &opt))
+	    {
+		report("lines", pat, ic, lines, count, lnum,
+					     r_first, &first, r, &opt);
+		++errors;
+	    }
+	}
+    }
+
+theend:
+    vim_free(opt.regprog);
+    vim_free(ref.regprog);
+    return errors;
+}
+
+/*
+ * Run "count" random tests.  Returns the number of differences found.
+ */
+    static int
+fuzz(count)
+    long	count;
+{
+    char_u	buf[FUZZ_MAXLINES][FUZZ_MAXLEN * 4 + 1];
+    char_u	*lines[FUZZ_MAXLINES];
+    garray_T	ga;
+    long	i;
+    long	skipped = 0;
+    int		nlines;
+    int		errors = 0;
+
+    if (enc_utf8)
+    {
+	(*mb_char2bytes)(0xe9, fuzz_lower);	/* e with acute */
+	(*mb_char2bytes)(0xc9, fuzz_upper);
+    }
+    else
+    {
+	fuzz_lower[0] = 0xe9;
+	fuzz_upper[0] = 0xc9;
+    }
+
+    for (i = 0; i < FUZZ_MAXLINES; ++i)
+	lines[i] = buf[i];
+    ga_init2(&ga, 1, 100);
+    for (i = 0; i < count; ++i)
+    {
+	/* Using this seed with a count of one repeats the test. */
+	case_seed = rnd_seed;
+	ga.ga_len = 0;
+	gen_pat(&ga, 0);
+
+	ga_append(&ga, NUL);
+	nlines = rnd(FUZZ_MAXLINES) + 1;
+	gen_text(lines, nlines);
+	shim_set_lines(lines, (long)nlines);
+
+	errors += fuzz_one((char_u *)ga.ga_data, FALSE, lines, nlines);
+	errors += fuzz_one((char_u *)ga.ga_data, TRUE, lines, nlines);
+	if (called_emsg)
+	    ++skipped;
+	if (errors > 20)
+	    break;
+    }
+    ga_clear(&ga);
+    printf("%ld patterns, %ld skipped, %d differences\n", i, skipped, errors);
+    return errors;
+}
+
+    int
+main(argc, argv)
+    int		argc;
+    char	**argv;
+{
+    int		do_fuzz = FALSE;
+    int		utf8 = FALSE;
+    int		verbose = FALSE;
+    long	count = -1;
+    long	nlines = 20000L;
+    char_u	**lines;
+
+    for (++argv, --argc; argc > 0 && argv[0][0] == '-'; ++argv, --argc)
+    {
+	switch (argv[0][1])
+	{
+	    case 'f': do_fuzz = TRUE; break;
+	    case 'u': utf8 = TRUE; break;
+	    case 'v': verbose = TRUE; break;
+	    case 's':
+	    case 'c':
+	    case 'n':
+		if (argc < 2)
+		    usage();
+		if (argv[0][1] == 's')
+		    rnd_seed = (unsigned long)atol(argv[1]);
+		else if (argv[0][1] == 'c')
+		    count = atol(argv[1]);
+		else
+		    nlines = atol(argv[1]);
+		++argv;
+		--argc;
+		break;
+	    default: usage();
+	}
+    }
+    shim_init(utf8, verbose);
+
+    if (do_fuzz)
+    {
+	if (argc > 0)
+	    usage();
+	return fuzz(count < 0 ? 10000L : count) > 0 ? 1 : 0;
+    }
+
+    if (argc > 0)
+	lines = read_lines(argc, argv, &nlines);
+    else
+	lines = gen_lines(nlines);
+    if (nlines <= 0)
+	usage();
+    bench(lines, nlines);
+    return 0;
+}
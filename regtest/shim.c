@@ -0,0 +1,488 @@
+/* vi:set ts=8 sts=4 sw=4:
+ *
+ * VIM - Vi IMproved	by Bram Moolenaar
+ *
+ * Do ":help uganda"  in Vim to read copying and usage conditions.
+ * Do ":help credits" in Vim to see a list of people who contributed.
+ */
+
+/*
+ * shim.c: The parts of Vim that regexp.c, mbyte.c and charset.c need, so that
+ * they can be linked into the regtest program without the rest of the editor.
+ *
+ * The global variables are defined here, like main.c does for Vim.  There is
+ * one buffer and one window.  The text of the buffer is an array of lines
+ * set with shim_set_lines().  Everything else is either a plain copy of what
+ * Vim does or a dummy that does nothing.
+ */
+
+#define EXTERN
+#include "vim.h"
+
+static char_u	**shim_lines = NULL;	/* text of the buffer */
+static long	shim_count = 0;		/* number of lines in shim_lines */
+static int	shim_verbose = FALSE;	/* report error messages */
+
+void shim_init __ARGS((int utf8, int verbose));
+void shim_set_lines __ARGS((char_u **lines, long count));
+
+/*
+ * Initialize the options, the buffer and the window.  Use 'encoding' "utf-8"
+ * when "utf8" is TRUE, "latin1" otherwise.  When "verbose" is TRUE error
+ * messages are written to stderr.
+ */
+    void
+shim_init(utf8, verbose)
+    int		utf8;
+    int		verbose;
+{
+    shim_verbose = verbose;
+
+    curbuf = (buf_T *)alloc_clear((unsigned)sizeof(buf_T));
+    curwin = (win_T *)alloc_clear((unsigned)sizeof(win_T));
+    if (curbuf == NULL || curwin == NULL)
+	mch_exit(2);
+    firstbuf = lastbuf = curbuf;
+    curwin->w_buffer = curbuf;
+
+    /* The defaults from the options table in option.c. */
+    p_cpo = (char_u *)CPO_VIM;
+    p_isi = (char_u *)"@,48-57,_,192-255";
+    p_isp = (char_u *)"@,161-255";
+    p_isf = (char_u *)"@,48-57,/,.,-,_,+,,,#,$,%,~,=";
+    p_magic = TRUE;
+    p_mmp = 1000L;
+    curbuf->b_p_isk = (char_u *)"@,48-57,_,192-255";
+    curbuf->b_p_ts = 8;
+    curbuf->b_p_smc = 3000;
+
+    p_enc = (char_u *)(utf8 ? "utf-8" : "latin1");
+    if (mb_init() != NULL || init_chartab() == FAIL)
+    {
+	fprintf(stderr, "cannot set 'encoding' to %s\n", p_enc);
+	mch_exit(2);
+    }
+}
+
+/*
+ * Make "lines[count]" the text of the buffer.  The lines are not copied.
+ */
+    void
+shim_set_lines(lines, count)
+    char_u	**lines;
+    long	count;
+{
+    shim_lines = lines;
+    shim_count = count;
+    curbuf->b_ml.ml_line_count = count;
+    curwin->w_cursor.lnum = 1;
+    curwin->w_cursor.col = 0;
+}
+
+    char_u *
+ml_get_buf(buf, lnum, will_change)
+    buf_T	*buf;
+    linenr_T	lnum;
+    int		will_change;
+{
+    if (lnum < 1 || lnum > shim_count)
+	return (char_u *)"";
+    return shim_lines[lnum - 1];
+}
+
+    char_u *
+ml_get(lnum)
+    linenr_T	lnum;
+{
+    return ml_get_buf(curbuf, lnum, FALSE);
+}
+
+    char_u *
+ml_get_cursor()
+{
+    return ml_get(curwin->w_cursor.lnum) + curwin->w_cursor.col;
+}
+
+/*
+ * Memory allocation, as in misc2.c.
+ */
+    char_u *
+alloc(size)
+    unsigned	size;
+{
+    return lalloc((long_u)size, TRUE);
+}
+
+    char_u *
+alloc_clear(size)
+    unsigned	size;
+{
+    char_u	*p;
+
+    p = lalloc((long_u)size, TRUE);
+    if (p != NULL)
+	vim_memset(p, 0, (size_t)size);
+    return p;
+}
+
+    char_u *
+lalloc(size, message)
+    long_u	size;
+    int		message;
+{
+    char_u	*p;
+
+    /* Always allocate something, malloc(0) may return NULL. */
+    p = (char_u *)malloc((size_t)(size == 0 ? 1 : size));
+    if (p == NULL && message)
+	emsg(e_outofmem);
+    return p;
+}
+
+    void
+vim_free(x)
+    void	*x;
+{
+    if (x != NULL)
+	free(x);
+}
+
+    char_u *
+vim_strsave(string)
+    char_u	*string;
+{
+    return vim_strnsave(string, (int)STRLEN(string));
+}
+
+    char_u *
+vim_strnsave(string, len)
+    char_u	*string;
+    int		len;
+{
+    char_u	*p;
+
+    p = alloc((unsigned)(len + 1));
+    if (p != NULL)
+    {
+	STRNCPY(p, string, len);
+	p[len] = NUL;
+    }
+    return p;
+}
+
+    void
+vim_strncpy(to, from, len)
+    char_u	*to;
+    char_u	*from;
+    size_t	len;
+{
+    STRNCPY(to, from, len);
+    to[len] = NUL;
+}
+
+    int
+vim_strnicmp(s1, s2, len)
+    char	*s1;
+    char	*s2;
+    size_t	len;
+{
+    int		i;
+
+    while (len > 0)
+    {
+	i = (int)TOLOWER_LOC(*s1) - (int)TOLOWER_LOC(*s2);
+	if (i != 0)
+	    return i;
+	if (*s1 == NUL)
+	    break;
+	++s1;
+	++s2;
+	--len;
+    }
+    return 0;
+}
+
+/*
+ * Version of strchr() that handles multi-byte characters, as in misc2.c.
+ */
+    char_u *
+vim_strchr(string, c)
+    char_u	*string;
+    int		c;
+{
+    char_u	*p;
+
+    for (p = string; *p != NUL; p += (*mb_ptr2len)(p))
+	if ((enc_utf8 ? utf_ptr2char(p) : *p) == c)
+	    return p;
+    return NULL;
+}
+
+    char_u *
+vim_strbyte(string, c)
+    char_u	*string;
+    int		c;
+{
+    char_u	*p;
+
+    for (p = string; *p != NUL; ++p)
+	if (*p == c)
+	    return p;
+    return NULL;
+}
+
+    char_u *
+skip_to_option_part(p)
+    char_u	*p;
+{
+    if (*p == ',')
+	++p;
+    while (*p == ' ')
+	++p;
+    return p;
+}
+
+/*
+ * Growing arrays, as in misc2.c.
+ */
+    void
+ga_init2(gap, itemsize, growsize)
+    garray_T	*gap;
+    int		itemsize;
+    int		growsize;
+{
+    gap->ga_data = NULL;
+    gap->ga_maxlen = 0;
+    gap->ga_len = 0;
+    gap->ga_itemsize = itemsize;
+    gap->ga_growsize = growsize;
+}
+
+    void
+ga_clear(gap)
+    garray_T	*gap;
+{
+    vim_free(gap->ga_data);
+    ga_init2(gap, gap->ga_itemsize, gap->ga_growsize);
+}
+
+    int
+ga_grow(gap, n)
+    garray_T	*gap;
+    int		n;
+{
+    char_u	*pp;
+
+    if (gap->ga_maxlen - gap->ga_len < n)
+    {
+	if (n < gap->ga_growsize)
+	    n = gap->ga_growsize;
+	pp = alloc_clear((unsigned)(gap->ga_itemsize * (gap->ga_len + n)));
+	if (pp == NULL)
+	    return FAIL;
+	gap->ga_maxlen = gap->ga_len + n;
+	if (gap->ga_data != NULL)
+	{
+	    mch_memmove(pp, gap->ga_data,
+				    (size_t)(gap->ga_itemsize * gap->ga_len));
+
+	    vim_free(gap->ga_data);
+	}
+	gap->ga_data = pp;
+    }
+    return OK;
+}
+
+    void
+ga_concat(gap, s)
+    garray_T	*gap;
+    char_u	*s;
+{
+    int    len = (int)STRLEN(s);
+
+    if (ga_grow(gap, len) == OK)
+    {
+	mch_memmove((char *)gap->ga_data + gap->ga_len, s, (size_t)len);
+	gap->ga_len += len;
+    }
+}
+
+    void
+ga_append(gap, c)
+    garray_T	*gap;
+    int		c;
+{
+    if (ga_grow(gap, 1) == OK)
+    {
+	*((char *)gap->ga_data + gap->ga_len) = c;
+	++gap->ga_len;
+    }
+}
+
+/*
+ * Messages: only remember that there was an error.
+ */
+    int
+emsg(s)
+    char_u	*s;
+{
+    called_emsg = TRUE;
+    did_emsg = TRUE;
+    if (shim_verbose)
+	fprintf(stderr, "%s\n", (char *)s);
+    return TRUE;
+}
+
+    int
+emsg2(s, a1)
+    char_u	*s;
+    char_u	*a1;
+{
+    called_emsg = TRUE;
+    did_emsg = TRUE;
+    if (shim_verbose)
+    {
+	fprintf(stderr, (char *)s, (char *)a1);
+	fprintf(stderr, "\n");
+    }
+    return TRUE;
+}
+
+    int
+msg(s)
+    char_u	*s;
+{
+    return TRUE;
+}
+
+    void
+beep_flush()
+{
+}
+
+/*
+ * Checking for CTRL-C is left to the system, the budget limits the time
+ * spent on one match.
+ */
+    void
+fast_breakcheck()
+{
+}
+
+    void
+line_breakcheck()
+{
+}
+
+/*
+ * Dummies for what is not used when matching.
+ */
+    pos_T *
+getmark(c, changefile)
+    int		c;
+    int		changefile;
+{
+    return NULL;
+}
+
+    int
+virtual_active()
+{
+    return FALSE;
+}
+
+    int
+win_col_off(wp)
+    win_T	*wp;
+{
+    return 0;
+}
+
+    int
+win_col_off2(wp)
+    win_T	*wp;
+{
+    return 0;
+}
+
+    int
+check_col(col)
+    int		col;
+{
+    return col;
+}
+
+    int
+check_row(row)
+    int		row;
+{
+    return row;
+}
+
+    void
+screenalloc(clear)
+    int		clear;
+{
+}
+
+    int
+get_fileformat(buf)
+    buf_T	*buf;
+{
+    return EOL_UNIX;
+}
+
+    char_u *
+get_encoding_default()
+{
+    return NULL;
+}
+
+    int
+option_was_set(name)
+    char_u	*name;
+{
+    return FALSE;
+}
+
+    void
+set_string_option_direct(name, opt_idx, val, opt_flags, set_sid)
+    char_u	*name;
+    int		opt_idx;
+    char_u	*val;
+    int		opt_flags;
+    int		set_sid;
+{
+}
+
+    void
+spell_reload()
+{
+}
+
+    int
+apply_autocmds(event, fname, fname_io, force, buf)
+    event_T	event;
+    char_u	*fname;
+    char_u	*fname_io;
+    int		force;
+    buf_T	*buf;
+{
+    return FALSE;
+}
+
+    char_u *
+eval_to_string(arg, nextcmd, dolist)
+    char_u	*arg;
+    char_u	**nextcmd;
+    int		dolist;
+{
+    return NULL;
+}
+
+    void
+mch_exit(r)
+    int		r;
+{
+    exit(r);
+}
@@ -123,6 +123,17 @@ static match_T search_hl;	/* used for 'hlsearch' highlight matching */
 static match_T match_hl[3];	/* used for ":match" highlight matching */
 #endif
 
+#if defined(FEAT_SEARCH_EXTRA) || defined(FEAT_SYN_HL)
+/* Limit for matching 'hlsearch' and ":match" patterns while redrawing a
+ * window, see 'redrawtime'. */
+static regbudget_T redraw_budget;
+#endif
+#ifdef FEAT_SYN_HL
+/* Same for syntax patterns.  Separate, so that a slow search pattern doesn't
+ * cause syntax highlighting to be switched off. */
+static regbudget_T syn_redraw_budget;
+#endif
+
 #ifdef FEAT_FOLDING
 static foldinfo_T win_foldinfo;	/* info for 'foldcolumn' */
 #endif
@@ -141,6 +152,7 @@ static void copy_text_attr __ARGS((int off, char_u *buf, int len, int attr));
 #endif
 static int win_line __ARGS((win_T *, linenr_T, int, int, int nochange));
 static int char_needs_redraw __ARGS((int off_from, int off_to, int cols));
+static int screen_cells_equal __ARGS((int off_from, int off_to, int cols));
 #ifdef FEAT_RIGHTLEFT
 static void screen_line __ARGS((int row, int coloff, int endcol, int clear_width, int rlflag));
 # define SCREEN_LINE(r, o, e, c, rl)    screen_line((r), (o), (e), (c), (rl))
@@ -169,8 +181,7 @@ static void screenclear2 __ARGS((void));
 static void lineclear __ARGS((unsigned off, int width));
 static void lineinvalid __ARGS((unsigned off, int width));
 #ifdef FEAT_VERTSPLIT
-static void linecopy __ARGS((int to, int from, win_T *wp));
-static void redraw_block __ARGS((int row, int end, win_T *wp));
+static void linecopy __ARGS((int to, int from, win_T *wp, int redraw));
 #endif
 static int win_do_lines __ARGS((win_T *wp, int row, int line_count, int mayclear, int del));
 static void win_rest_invalid __ARGS((win_T *wp));
@@ -847,6 +858,15 @@ win_update(wp)
     }
 #endif
 
+#if defined(FEAT_SEARCH_EXTRA) || defined(FEAT_SYN_HL)
+    /* Matching patterns for this window may take up to 'redrawtime'. */
+    regbudget_init(&redraw_budget, p_rdt);
+#endif
+#ifdef FEAT_SYN_HL
+    regbudget_init(&syn_redraw_budget, p_rdt);
+    syn_set_budget(&syn_redraw_budget);
+#endif
+
 #ifdef FEAT_SEARCH_EXTRA
     /* Setup for ":match" and 'hlsearch' highlighting.  Disable any previous
      * match */
@@ -1931,6 +1951,10 @@ win_update(wp)
 	}
     }
 
+#ifdef FEAT_SYN_HL
+    syn_set_budget(NULL);
+#endif
+
 #if defined(FEAT_SYN_HL) || defined(FEAT_SEARCH_EXTRA)
     /* restore got_int, unless CTRL-C was hit while redrawing */
     if (!got_int)
@@ -2686,13 +2710,14 @@ win_line(wp, lnum, startrow, endrow, nochange)
     extra_check = 0;
 #endif
 #ifdef FEAT_SYN_HL
-    if (syntax_present(wp->w_buffer) && !wp->w_buffer->b_syn_error)
+    if (syntax_present(wp->w_buffer) && !wp->w_buffer->b_syn_error
+						&& !wp->w_buffer->b_syn_slow)
     {
 	/* Prepare for syntax highlighting in this line.  When there is an
 	 * error, stop syntax highlighting. */
 	save_did_emsg = did_emsg;
 	did_emsg = FALSE;
-	syntax_start(wp, lnum);
+	syntax_start_draw(wp, lnum);
 	if (did_emsg)
 	    wp->w_buffer->b_syn_error = TRUE;
 	else
@@ -2964,7 +2989,17 @@ win_line(wp, lnum, startrow, endrow, nochange)
     if (v > 0)
     {
 #ifdef FEAT_MBYTE
-	char_u	*prev_ptr = ptr;
+	char_u	*prev_ptr;
+#endif
+	colnr_T	cp_vcol;
+
+	/* In a long line start at a checkpoint before "v", see
+	 * vcol_checkpoint().  The loop below then moves at least once. */
+	ptr += vcol_checkpoint(wp, lnum, ptr, MAXCOL, (colnr_T)v - 1,
+								    &cp_vcol);
+	vcol = cp_vcol;
+#ifdef FEAT_MBYTE
+	prev_ptr = ptr;
 #endif
 	while (vcol < v && *ptr != NUL)
 	{
@@ -3043,7 +3078,7 @@ win_line(wp, lnum, startrow, endrow, nochange)
 # ifdef FEAT_SYN_HL
 	    /* Need to restart syntax highlighting for this line. */
 	    if (has_syntax)
-		syntax_start(wp, lnum);
+		syntax_start_draw(wp, lnum);
 # endif
 	}
 #endif
@@ -3828,7 +3863,12 @@ win_line(wp, lnum, startrow, endrow, nochange)
 			has_syntax = FALSE;
 		    }
 		    else
+		    {
 			did_emsg = save_did_emsg;
+			/* Stop when matching took too long. */
+			if (wp->w_buffer->b_syn_slow)
+			    has_syntax = FALSE;
+		    }
 
 		    /* Need to get the line again, a multi-line regexp may
 		     * have made it invalid. */
@@ -4760,6 +4800,63 @@ char_needs_redraw(off_from, off_to, cols)
     return FALSE;
 }
 
+/*
+ * Return the number of screen cells from "off_from" and "off_to" on that are
+ * equal, at most "cols".  Used to skip over unchanged text in screen_line()
+ * without checking each character.  Does not stop halfway a double-wide
+ * character.  Not to be used for DBCS.
+ */
+    static int
+screen_cells_equal(off_from, off_to, cols)
+    int		off_from;
+    int		off_to;
+    int		cols;
+{
+    int		n;
+
+    /* Most often the whole line is unchanged, check that in one go. */
+    if (memcmp(ScreenLines + off_from, ScreenLines + off_to,
+					       cols * sizeof(schar_T)) == 0
+	    && memcmp(ScreenAttrs + off_from, ScreenAttrs + off_to,
+					       cols * sizeof(sattr_T)) == 0
+#ifdef FEAT_MBYTE
+	    && (!enc_utf8 || memcmp(ScreenLinesUC + off_from,
+			ScreenLinesUC + off_to, cols * sizeof(u8char_T)) == 0)
+#endif
+	    )
+	n = cols;
+    else
+	for (n = 0; n < cols; ++n)
+	    if (ScreenLines[off_from + n] != ScreenLines[off_to + n]
+		    || ScreenAttrs[off_from + n] != ScreenAttrs[off_to + n]
+#ifdef FEAT_MBYTE
+		    || (enc_utf8 && ScreenLinesUC[off_from + n]
+						  != ScreenLinesUC[off_to + n])
+#endif
+		    )
+		break;
+
+#ifdef FEAT_MBYTE
+    if (enc_utf8)
+    {
+	int	i;
+
+	for (i = 0; i < n; ++i)
+	    if (ScreenLinesUC[off_from + i] != 0
+			       && comp_char_differs(off_from + i, off_to + i))
+	    {
+		n = i;
+		break;
+	    }
+
+	/* The right halve of a double-wide character has a zero byte. */
+	while (n > 0 && n < cols && ScreenLines[off_from + n] == 0)
+	    --n;
+    }
+#endif
+    return n;
+}
+
 /*
  * Move one "cooked" screen line to the screen, but only the characters that
  * have actually changed.  Handle insert/delete character.
@@ -4845,6 +4942,31 @@ screen_line(row, coloff, endcol, clear_width
 
     while (col < endcol)
     {
+	/* Skip over unchanged characters quickly.  Not when the previous
+	 * or next character matters for the one being redrawn. */
+	if (!redraw_next && !force && !p_wiv
+#ifdef FEAT_GUI
+		&& !gui.in_use
+#endif
+#ifdef FEAT_MBYTE
+		&& enc_dbcs == 0
+#endif
+		)
+	{
+	    int	    n = screen_cells_equal(off_from, off_to, endcol - col);
+
+	    if (n > 0)
+	    {
+		off_to += n;
+		off_from += n;
+		col += n;
+		if (col >= endcol)
+		    break;
+		redraw_next = char_needs_redraw(off_from, off_to,
+								endcol - col);
+	    }
+	}
+
 #ifdef FEAT_MBYTE
 	if (has_mbyte && (col + 1 < endcol))
 	    char_cells = (*mb_off2cells)(off_from);
@@ -6433,6 +6555,14 @@ next_search_hl(win, shl, lnum, mincol)
 	    return;
     }
 
+    /*
+     * When the match index says there is no match in this line, don't
+     * search it.
+     */
+    if (shl == &search_hl && shl->lnum == 0
+		      && search_idx_line(shl->buf, lnum, &redraw_budget) == 0)
+	return;
+
     /*
      * Repeat searching for a match until one is found that includes "mincol"
      * or none is found in this line.
@@ -6473,7 +6603,8 @@ next_search_hl(win, shl, lnum, mincol)
 	    matchcol = shl->rm.endpos[0].col;
 
 	shl->lnum = lnum;
-	nmatched = vim_regexec_multi(&shl->rm, win, shl->buf, lnum, matchcol);
+	nmatched = vim_regexec_multi(&shl->rm, win, shl->buf, lnum, matchcol,
+							      &redraw_budget);
 	if (called_emsg)
 	{
 	    /* Error while handling regexp: stop using this regexp. */
@@ -6860,37 +6991,6 @@ screen_draw_rectangle(row, col, height, width, invert)
 }
 #endif
 
-#ifdef FEAT_VERTSPLIT
-/*
- * Redraw the characters for a vertically split window.
- */
-    static void
-redraw_block(row, end, wp)
-    int		row;
-    int		end;
-    win_T	*wp;
-{
-    int		col;
-    int		width;
-
-# ifdef FEAT_CLIPBOARD
-    clip_may_clear_selection(row, end - 1);
-# endif
-
-    if (wp == NULL)
-    {
-	col = 0;
-	width = Columns;
-    }
-    else
-    {
-	col = wp->w_wincol;
-	width = wp->w_width;
-    }
-    screen_draw_rectangle(row, col, end - row, width, FALSE);
-}
-#endif
-
 /*
  * Fill the screen from 'start_row' to 'end_row', from 'start_col' to 'end_col'
  * with character 'c1' in first column followed by 'c2' in the other columns.
@@ -7536,16 +7636,23 @@ lineinvalid(off, width)
 #ifdef FEAT_VERTSPLIT
 /*
  * Copy part of a Screenline for vertically split window "wp".
+ * When "redraw" is TRUE the terminal can't scroll this part of the screen,
+ * output the characters that change.
  */
     static void
-linecopy(to, from, wp)
+linecopy(to, from, wp, redraw)
     int		to;
     int		from;
     win_T	*wp;
+    int		redraw;
 {
     unsigned	off_to = LineOffset[to] + wp->w_wincol;
     unsigned	off_from = LineOffset[from] + wp->w_wincol;
 
+    /* Copy to current_ScreenLine[], screen_line() moves it into place. */
+    if (redraw)
+	off_to = (unsigned)(current_ScreenLine - ScreenLines);
+
     mch_memmove(ScreenLines + off_to, ScreenLines + off_from,
 	    wp->w_width * sizeof(schar_T));
 # ifdef FEAT_MBYTE
@@ -7565,6 +7672,13 @@ linecopy(to, from, wp)
 # endif
     mch_memmove(ScreenAttrs + off_to, ScreenAttrs + off_from,
 	    wp->w_width * sizeof(sattr_T));
+
+    if (redraw)
+	screen_line(to, wp->w_wincol, wp->w_width, -wp->w_width
+# ifdef FEAT_RIGHTLEFT
+		, FALSE
+# endif
+		);
 }
 #endif
 
@@ -8280,9 +8394,12 @@ screen_ins_lines(off, row, line_count, end, wp)
 	    /* need to copy part of a line */
 	    j = end - 1 - i;
 	    while ((j -= line_count) >= row)
-		linecopy(j + line_count, j, wp);
+		linecopy(j + line_count, j, wp, type == USE_REDRAW);
 	    j += line_count;
-	    if (can_clear((char_u *)" "))
+	    if (type == USE_REDRAW)
+		screen_fill(j, j + 1, wp->w_wincol,
+				   wp->w_wincol + wp->w_width, ' ', ' ', 0);
+	    else if (can_clear((char_u *)" "))
 		lineclear(LineOffset[j] + wp->w_wincol, wp->w_width);
 	    else
 		lineinvalid(LineOffset[j] + wp->w_wincol, wp->w_width);
@@ -8308,20 +8425,22 @@ screen_ins_lines(off, row, line_count, end, wp)
     }
 
     screen_stop_highlight();
-    windgoto(cursor_row, 0);
-
 #ifdef FEAT_VERTSPLIT
-    /* redraw the characters */
+    /* With USE_REDRAW linecopy() already output the changed characters. */
+    if (type != USE_REDRAW)
+#endif
+	windgoto(cursor_row, 0);
+
+#if defined(FEAT_VERTSPLIT) && defined(FEAT_CLIPBOARD)
     if (type == USE_REDRAW)
-	redraw_block(row, end, wp);
-    else
+	clip_may_clear_selection(row, end - 1);
 #endif
-	if (type == USE_T_CAL)
+    if (type == USE_T_CAL)
     {
 	term_append_lines(line_count);
 	screen_start();		/* don't know where cursor is now */
     }
-    else
+    else if (type != USE_REDRAW)
     {
 	for (i = 0; i < line_count; i++)
 	{
@@ -8508,9 +8627,12 @@ screen_del_lines(off, row, line_count, end, force, wp)
 	    /* need to copy part of a line */
 	    j = row + i;
 	    while ((j += line_count) <= end - 1)
-		linecopy(j - line_count, j, wp);
+		linecopy(j - line_count, j, wp, type == USE_REDRAW);
 	    j -= line_count;
-	    if (can_clear((char_u *)" "))
+	    if (type == USE_REDRAW)
+		screen_fill(j, j + 1, wp->w_wincol,
+				   wp->w_wincol + wp->w_width, ' ', ' ', 0);
+	    else if (can_clear((char_u *)" "))
 		lineclear(LineOffset[j] + wp->w_wincol, wp->w_width);
 	    else
 		lineinvalid(LineOffset[j] + wp->w_wincol, wp->w_width);
@@ -8538,13 +8660,12 @@ screen_del_lines(off, row, line_count, end, force, wp)
 
     screen_stop_highlight();
 
-#ifdef FEAT_VERTSPLIT
-    /* redraw the characters */
+    /* With USE_REDRAW linecopy() already output the changed characters. */
+#if defined(FEAT_VERTSPLIT) && defined(FEAT_CLIPBOARD)
     if (type == USE_REDRAW)
-	redraw_block(row, end, wp);
-    else
+	clip_may_clear_selection(row, end - 1);
 #endif
-	if (type == USE_T_CD)	/* delete the lines */
+    if (type == USE_T_CD)	/* delete the lines */
     {
 	windgoto(cursor_row, 0);
 	out_str(T_CD);
@@ -8567,7 +8688,7 @@ screen_del_lines(off, row, line_count, end, force, wp)
 	for (i = line_count; --i >= 0; )
 	    out_char('\n');		/* cursor will remain on same line */
     }
-    else
+    else if (type != USE_REDRAW)
     {
 	for (i = line_count; --i >= 0; )
 	{
@@ -16,10 +16,26 @@ static void save_re_pat __ARGS((int idx, char_u *pat, int magic));
 #ifdef FEAT_EVAL
 static int first_submatch __ARGS((regmmatch_T *rp));
 #endif
+#ifdef FEAT_SEARCH_EXTRA
+static int search_idx_current __ARGS((buf_T *buf));
+static void search_idx_init __ARGS((buf_T *buf));
+static void search_idx_drop __ARGS((searchidx_T *si));
+static int search_idx_scan_line __ARGS((buf_T *buf, linenr_T lnum,
+					colnr_T maxcol, regbudget_T *budget));
+static int search_idx_set __ARGS((buf_T *buf, linenr_T lnum,
+						       regbudget_T *budget));
+static void search_idx_fill __ARGS((buf_T *buf, long maxlines,
+						       regbudget_T *budget));
+static void search_idx_show __ARGS((pos_T *pos, int echo_col));
+#endif
 static int check_prevcol __ARGS((char_u *linep, int col, int ch, int *prevcol));
 static int inmacro __ARGS((char_u *, char_u *));
 static int check_linecomment __ARGS((char_u *line));
+static colnr_T findsent_skip __ARGS((char_u *line, colnr_T col, int dir));
 static int cls __ARGS((void));
+static int cls_char __ARGS((char_u *p));
+static void cls_fwd __ARGS((int cclass));
+static void cls_bck __ARGS((int cclass));
 static int skip_chars __ARGS((int, int));
 #ifdef FEAT_TEXTOBJ
 static void back_in_line __ARGS((void));
@@ -105,6 +121,40 @@ static char_u	    *reverse_text __ARGS((char_u *s));
 #endif
 
 #ifdef FEAT_FIND_ID
+/*
+ * What find_pattern_in_path() found out about an included file, so that the
+ * next time it doesn't have to read the whole file again when looking for an
+ * identifier that isn't in it.  Valid as long as the file's size and time,
+ * the options used and the directories in 'path' are the same.
+ */
+typedef struct inclfile_S
+{
+    struct inclfile_S *if_next;	/* next in "incl_cache" */
+    char_u	*if_name;	/* file name */
+    long	if_size;	/* size of the file */
+    time_t	if_mtime;	/* modification time of the file */
+    int		if_dirs_ok;	/* 'path' has no wildcards */
+    long_u	if_dirstamp;	/* see incl_dir_stamp() */
+    char_u	*if_sig;	/* options used, see incl_cache_sig() */
+    char_u	*if_words;	/* Bloom filter with identifiers in the file */
+    long_u	if_wordmask;	/* number of bits in "if_words" minus one */
+    int		if_nonascii;	/* an identifier has non-ASCII chars */
+    garray_T	if_lines;	/* lines matching 'include', inclline_T */
+    linenr_T	if_lnum;	/* number of lines read */
+} inclfile_T;
+
+typedef struct
+{
+    linenr_T	il_lnum;	/* line number */
+    long	il_offset;	/* byte offset of the line in the file */
+    char_u	*il_fname;	/* file name found for it or NULL */
+} inclline_T;
+
+static inclfile_T *incl_cache = NULL;	/* most recently used first */
+static int	incl_cache_len = 0;	/* number of entries in "incl_cache" */
+
+#define INCL_CACHE_MAX	500	/* max number of files in "incl_cache" */
+
 /*
  * Type used by find_pattern_in_path() to remember which included files have
  * been searched already.
@@ -115,7 +165,24 @@ typedef struct SearchedFile
     char_u	*name;		/* Full name of file */
     linenr_T	lnum;		/* Line we were up to in file */
     int		matched;	/* Found a match in this file */
+    inclfile_T	*incl;		/* cached info for the file or NULL */
+    int		building;	/* "incl" is being filled */
+    int		skip;		/* only read lines matching 'include' */
+    int		incl_idx;	/* next entry in incl->if_lines */
+    long	offset;		/* byte offset of the line last read */
 } SearchedFile;
+
+static char_u *incl_cache_sig __ARGS((char_u *inc_opt));
+static int incl_dir_stamp __ARGS((char_u *fname, long_u *stampp));
+static inclfile_T *incl_cache_find __ARGS((char_u *fname, char_u *sig));
+static inclfile_T *incl_cache_new __ARGS((char_u *fname, char_u *sig));
+static void incl_cache_add __ARGS((inclfile_T *ifp));
+static void incl_cache_trim __ARGS((void));
+static void incl_cache_free __ARGS((inclfile_T *ifp));
+static long_u incl_word_hash __ARGS((char_u *p, int len));
+static void incl_cache_words __ARGS((inclfile_T *ifp, char_u *line));
+static int incl_cache_has_word __ARGS((inclfile_T *ifp, char_u *word, int len));
+static int incl_fgets __ARGS((SearchedFile *sf, char_u *buf));
 #endif
 
 /*
@@ -474,6 +541,397 @@ last_pat_prog(regmatch)
     (void)search_regcomp((char_u *)"", 0, last_idx, SEARCH_KEEP, regmatch);
     --emsg_off;
 }
+
+/*
+ * Match index for the last used search pattern.
+ *
+ * Each buffer has a searchidx_T with the number of matches in every line.
+ * The lines in the window are filled in while redrawing, the rest while
+ * waiting for the user to type something, see search_idx_idle().  A line
+ * known not to match doesn't need to be searched for 'hlsearch'.
+ * Summing the counts gives the "[3/12]" shown after a search command.
+ */
+
+/* Nr of lines scanned at a time while waiting for a character. */
+#define SI_IDLE_LINES	200
+
+/* Nr of lines scanned at most before showing the match count. */
+#define SI_SYNC_LINES	20000L
+
+/*
+ * Return TRUE when the index of "buf" is for the last used search pattern
+ * and the current option values.
+ */
+    static int
+search_idx_current(buf)
+    buf_T	*buf;
+{
+    searchidx_T	*si = &buf->b_search_idx;
+
+    return (si->si_pat != NULL
+	    && spats[last_idx].pat != NULL
+	    && STRCMP(si->si_pat, spats[last_idx].pat) == 0
+	    && si->si_magic == spats[last_idx].magic
+	    && si->si_no_scs == spats[last_idx].no_scs
+	    && si->si_ic == p_ic
+	    && si->si_scs == p_scs
+	    && si->si_cpo_search == (vim_strchr(p_cpo, CPO_SEARCH) != NULL)
+	    && vim_memcmp(si->si_chartab, buf->b_chartab, 32) == 0
+	    && si->si_chartab_tick == chartab_tick
+	    && (si->si_count == NULL
+			       || si->si_len == buf->b_ml.ml_line_count));
+}
+
+/*
+ * Start a new index for the last used search pattern in "buf", with all
+ * lines unknown.  When the pattern can't be indexed si_count is NULL.
+ */
+    static void
+search_idx_init(buf)
+    buf_T	*buf;
+{
+    searchidx_T	*si = &buf->b_search_idx;
+    linenr_T	lnum;
+
+    search_idx_free(buf);
+    if (spats[last_idx].pat == NULL || buf->b_ml.ml_mfp == NULL)
+	return;
+    si->si_pat = vim_strsave(spats[last_idx].pat);
+    if (si->si_pat == NULL)
+	return;
+    si->si_magic = spats[last_idx].magic;
+    si->si_no_scs = spats[last_idx].no_scs;
+    si->si_ic = p_ic;
+    si->si_scs = p_scs;
+    si->si_cpo_search = (vim_strchr(p_cpo, CPO_SEARCH) != NULL);
+    mch_memmove(si->si_chartab, buf->b_chartab, (size_t)32);
+    si->si_chartab_tick = chartab_tick;
+
+    last_pat_prog(&si->si_regmatch);
+    if (si->si_regmatch.regprog == NULL)
+	return;
+    if (re_multiline(si->si_regmatch.regprog)
+	    || re_stateful(si->si_regmatch.regprog))
+    {
+	search_idx_drop(si);
+	return;
+    }
+    si->si_len = buf->b_ml.ml_line_count;
+    si->si_count = (int *)lalloc((long_u)(si->si_len * sizeof(int)), FALSE);
+    if (si->si_count == NULL)
+    {
+	search_idx_drop(si);
+	return;
+    }
+    for (lnum = 0; lnum < si->si_len; ++lnum)
+	si->si_count[lnum] = SI_UNKNOWN;
+    si->si_unknown = si->si_len;
+    si->si_next = 1;
+}
+
+/*
+ * Free the index of "buf".
+ */
+    void
+search_idx_free(buf)
+    buf_T	*buf;
+{
+    searchidx_T	*si = &buf->b_search_idx;
+
+    search_idx_drop(si);
+    vim_free(si->si_pat);
+    si->si_pat = NULL;
+}
+
+/*
+ * Stop indexing for the pattern of "si", but remember the pattern, so that
+ * it's not tried again.
+ */
+    static void
+search_idx_drop(si)
+    searchidx_T	*si;
+{
+    vim_free(si->si_regmatch.regprog);
+    si->si_regmatch.regprog = NULL;
+    vim_free(si->si_count);
+    si->si_count = NULL;
+    si->si_len = 0;
+    si->si_unknown = 0;
+}
+
+/*
+ * Count the matches of the indexed pattern in line "lnum" of "buf" that start
+ * at or before column "maxcol".  Steps from one match to the next like
+ * searchit() does.
+ * Returns -1 when interrupted, when "budget" is used up or when the pattern
+ * gives an error.
+ */
+    static int
+search_idx_scan_line(buf, lnum, maxcol, budget)
+    buf_T	*buf;
+    linenr_T	lnum;
+    colnr_T	maxcol;
+    regbudget_T	*budget;	/* limit for matching or NULL */
+{
+    searchidx_T	*si = &buf->b_search_idx;
+    regmmatch_T	*rmp = &si->si_regmatch;
+    int		count = 0;
+    colnr_T	col = 0;
+    char_u	*ptr;
+    int		save_called_emsg = called_emsg;
+    int		failed;
+
+    called_emsg = FALSE;
+    ++emsg_off;
+    while (vim_regexec_multi(rmp, NULL, buf, lnum, col, budget) > 0)
+    {
+	if (rmp->startpos[0].col > maxcol)
+	    break;
+	++count;
+
+	ptr = ml_get_buf(buf, lnum, FALSE);
+	if (si->si_cpo_search)
+	    col = rmp->endpos[0].col;
+	else
+	    col = rmp->startpos[0].col;
+	if (ptr[col] != NUL
+		&& (!si->si_cpo_search || col == rmp->startpos[0].col))
+	{
+#ifdef FEAT_MBYTE
+	    if (has_mbyte)
+		col += (*mb_ptr2len)(ptr + col);
+	    else
+#endif
+		++col;
+	}
+	if (ptr[col] == NUL)
+	    break;
+    }
+    --emsg_off;
+    failed = (called_emsg || got_int
+				 || (budget != NULL && budget->rb_timed_out));
+    called_emsg |= save_called_emsg;
+    return failed ? -1 : count;
+}
+
+/*
+ * Scan line "lnum" for the index of "buf" and store the number of matches.
+ * Returns FAIL when interrupted, out of budget or when the index was dropped.
+ */
+    static int
+search_idx_set(buf, lnum, budget)
+    buf_T	*buf;
+    linenr_T	lnum;
+    regbudget_T	*budget;
+{
+    searchidx_T	*si = &buf->b_search_idx;
+    int		n;
+
+    n = search_idx_scan_line(buf, lnum, MAXCOL, budget);
+    if (n < 0)
+    {
+	/* Don't keep trying a pattern that gives an error. */
+	if (!got_int && (budget == NULL || !budget->rb_timed_out))
+	    search_idx_drop(si);
+	return FAIL;
+    }
+    if (si->si_count[lnum - 1] == SI_UNKNOWN)
+	--si->si_unknown;
+    si->si_count[lnum - 1] = n;
+    return OK;
+}
+
+/*
+ * Fill in unknown lines of the index of "buf", scanning at most "maxlines"
+ * lines.  Continues where the previous call stopped.
+ */
+    static void
+search_idx_fill(buf, maxlines, budget)
+    buf_T	*buf;
+    long	maxlines;
+    regbudget_T	*budget;
+{
+    searchidx_T	*si = &buf->b_search_idx;
+
+    while (si->si_count != NULL && si->si_unknown > 0 && maxlines > 0)
+    {
+	if (si->si_next < 1 || si->si_next > si->si_len)
+	    si->si_next = 1;
+	if (si->si_count[si->si_next - 1] == SI_UNKNOWN)
+	{
+	    if (search_idx_set(buf, si->si_next, budget) == FAIL)
+		break;
+	    --maxlines;
+	}
+	++si->si_next;
+    }
+}
+
+/*
+ * Return the number of matches of the last used search pattern that start in
+ * line "lnum" of "buf".  Scans the line when it's not in the index yet,
+ * using "budget" (can be NULL).
+ * Returns -1 when this is unknown.
+ */
+    int
+search_idx_line(buf, lnum, budget)
+    buf_T	*buf;
+    linenr_T	lnum;
+    regbudget_T	*budget;
+{
+    searchidx_T	*si = &buf->b_search_idx;
+
+    if (!search_idx_current(buf))
+	search_idx_init(buf);
+    if (si->si_count == NULL || lnum < 1 || lnum > si->si_len)
+	return -1;
+    if (si->si_count[lnum - 1] == SI_UNKNOWN
+			       && search_idx_set(buf, lnum, budget) == FAIL)
+	return -1;
+    return si->si_count[lnum - 1];
+}
+
+/*
+ * Lines "lnum" to "lnume" (not including) of "buf" were changed and "xtra"
+ * lines were inserted (negative when deleted), like for changed_lines().
+ * Shift the index entries below the change and forget the changed lines.
+ */
+    void
+search_idx_changed(buf, lnum, lnume, xtra)
+    buf_T	*buf;
+    linenr_T	lnum;
+    linenr_T	lnume;
+    long	xtra;
+{
+    searchidx_T	*si = &buf->b_search_idx;
+    linenr_T	l;
+    linenr_T	newlen;
+    linenr_T	newend;
+    int		*p;
+
+    if (si->si_count == NULL)
+	return;
+    newlen = si->si_len + xtra;
+    if (lnum < 1 || lnume < lnum || lnume > si->si_len + 1
+	    || newlen != buf->b_ml.ml_line_count)
+    {
+	/* Doesn't fit, must have missed a change: start all over. */
+	search_idx_free(buf);
+	return;
+    }
+
+    for (l = lnum; l < lnume; ++l)
+	if (si->si_count[l - 1] == SI_UNKNOWN)
+	    --si->si_unknown;
+    if (xtra > 0)
+    {
+	p = (int *)lalloc((long_u)(newlen * sizeof(int)), FALSE);
+	if (p == NULL)
+	{
+	    search_idx_free(buf);
+	    return;
+	}
+	mch_memmove(p, si->si_count, (size_t)(lnume - 1) * sizeof(int));
+	mch_memmove(p + lnume - 1 + xtra, si->si_count + lnume - 1,
+			      (size_t)(si->si_len - lnume + 1) * sizeof(int));
+	vim_free(si->si_count);
+	si->si_count = p;
+    }
+    else if (xtra < 0)
+	mch_memmove(si->si_count + lnume - 1 + xtra,
+				    si->si_count + lnume - 1,
+			      (size_t)(si->si_len - lnume + 1) * sizeof(int));
+    si->si_len = newlen;
+
+    newend = lnume + xtra;
+    if (newend < lnum)
+	newend = lnum;
+    for (l = lnum; l < newend; ++l)
+    {
+	si->si_count[l - 1] = SI_UNKNOWN;
+	++si->si_unknown;
+    }
+    if (si->si_next > lnum)
+	si->si_next = lnum;
+}
+
+/*
+ * Called while waiting for a character: index some lines of the current
+ * buffer.  Only does something when 'hlsearch' is active or an index was
+ * started for the match count.
+ * Returns TRUE when there is more to do.
+ */
+    int
+search_idx_idle()
+{
+    searchidx_T	*si = &curbuf->b_search_idx;
+    regbudget_T	budget;
+
+    if (curbuf->b_ml.ml_mfp == NULL || spats[last_idx].pat == NULL)
+	return FALSE;
+    if (!search_idx_current(curbuf))
+    {
+	if (si->si_pat == NULL && (!p_hls || no_hlsearch))
+	    return FALSE;
+	search_idx_init(curbuf);
+    }
+    regbudget_init(&budget, p_rdt);
+    search_idx_fill(curbuf, (long)SI_IDLE_LINES, &budget);
+    if (budget.rb_timed_out)
+	/* Matching is too slow for indexing this pattern. */
+	search_idx_drop(si);
+    return (si->si_count != NULL && si->si_unknown > 0 && !got_int);
+}
+
+/*
+ * Show "[N/M]" at the end of the command line for the match at "pos": it is
+ * match N of the M matches of the last used search pattern in the buffer.
+ * Shows "[?/??]" when there are too many lines to scan right now.
+ */
+    static void
+search_idx_show(pos, echo_col)
+    pos_T	*pos;
+    int		echo_col;	/* end of the echoed pattern */
+{
+    searchidx_T	*si = &curbuf->b_search_idx;
+    char_u	buf[50];
+    long	cur = 0;
+    long	total = 0;
+    linenr_T	lnum;
+    int		n;
+    int		col;
+    regbudget_T	budget;
+
+    if (!search_idx_current(curbuf))
+	search_idx_init(curbuf);
+    regbudget_init(&budget, p_rdt);
+    search_idx_fill(curbuf, SI_SYNC_LINES, &budget);
+    if (si->si_count == NULL || got_int)
+	return;
+
+    if (si->si_unknown > 0)
+	STRCPY(buf, "[?/??]");
+    else
+    {
+	for (lnum = 1; lnum <= si->si_len; ++lnum)
+	{
+	    if (lnum < pos->lnum)
+		cur += si->si_count[lnum - 1];
+	    total += si->si_count[lnum - 1];
+	}
+	n = search_idx_scan_line(curbuf, pos->lnum, pos->col, NULL);
+	if (n < 0)
+	    return;
+	sprintf((char *)buf, "[%ld/%ld]", cur + n, total);
+    }
+
+    /* Put it just before the 'showcmd' and 'ruler' area, if there is room
+     * after the pattern or warning message. */
+    col = sc_col - (int)STRLEN(buf) - 1;
+    if (col <= echo_col || col <= msg_col)
+	return;
+    screen_puts(buf, (int)Rows - 1, col, 0);
+}
 #endif
 
 /*
@@ -491,12 +949,15 @@ last_pat_prog(regmatch)
  * if (options & SEARCH_FOLD) match only once in a closed fold
  * if (options & SEARCH_PEEK) check for typed char, cancel search
  *
+ * When "budget" is not NULL searching stops when it's used up, this fails
+ * and "budget->rb_timed_out" is set.
+ *
  * Return FAIL (zero) for failure, non-zero for success.
  * When FEAT_EVAL is defined, returns the index of the first matching
  * subpattern plus one; one if there was none.
  */
     int
-searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum)
+searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum, budget)
     win_T	*win;		/* window to search in; can be NULL for a
 				   buffer without a window! */
     buf_T	*buf;
@@ -507,9 +968,12 @@ searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum)
     int		options;
     int		pat_use;	/* which pattern to use when "pat" is empty */
     linenr_T	stop_lnum;	/* stop after this line number when != 0 */
+    regbudget_T	*budget;	/* limit for searching or NULL */
 {
     int		found;
     linenr_T	lnum;		/* no init to shut up Apollo cc */
+    linenr_T	lnum_end;	/* last line to skip to */
+    linenr_T	found_lnum;
     regmmatch_T	regmatch;
     char_u	*ptr;
     colnr_T	matchcol;
@@ -593,12 +1057,48 @@ searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum)
 		    break;
 
 		/*
-		 * Look for a match somewhere in line "lnum".
+		 * Look for a match somewhere in line "lnum".  After the first
+		 * line, skip over the lines without a match in one go.
 		 */
-		nmatched = vim_regexec_multi(&regmatch, win, buf,
-							    lnum, (colnr_T)0);
-		/* Abort searching on an error (e.g., out of stack). */
-		if (called_emsg)
+		if (at_first_line)
+		    nmatched = vim_regexec_multi(&regmatch, win, buf,
+						    lnum, (colnr_T)0, budget);
+		else
+		{
+		    lnum_end = dir == FORWARD ? buf->b_ml.ml_line_count : 1;
+		    if (stop_lnum != 0 && (dir == FORWARD
+			       ? stop_lnum < lnum_end : stop_lnum > lnum_end))
+			lnum_end = stop_lnum;
+		    if (loop && (dir == FORWARD ? start_pos.lnum < lnum_end
+						: start_pos.lnum > lnum_end))
+			lnum_end = start_pos.lnum;
+#ifdef FEAT_SEARCH_EXTRA
+		    /* Don't skip the lines where a typed character is checked
+		     * for, see below. */
+		    if (options & SEARCH_PEEK)
+		    {
+			long	n = (lnum - pos->lnum) & 0x3f;
+
+			if (dir == FORWARD)
+			    n = (0x40 - n) & 0x3f;
+			if (n < (dir == FORWARD ? lnum_end - lnum
+						: lnum - lnum_end))
+			    lnum_end = lnum + dir * n;
+		    }
+#endif
+		    found_lnum = vim_regexec_lines(&regmatch, win, buf,
+					 lnum, lnum_end, &nmatched, budget);
+		    if (found_lnum == 0)
+		    {
+			lnum = lnum_end;
+			nmatched = 0;
+		    }
+		    else
+			lnum = found_lnum;
+		}
+		/* Abort searching on an error (e.g., out of stack) or when
+		 * the budget was used up. */
+		if (called_emsg || (budget != NULL && budget->rb_timed_out))
 		    break;
 		if (nmatched > 0)
 		{
@@ -683,7 +1183,7 @@ searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum)
 			    if (ptr[matchcol] == NUL
 				    || (nmatched = vim_regexec_multi(&regmatch,
 					      win, buf, lnum + matchpos.lnum,
-					      matchcol)) == 0)
+					      matchcol, budget)) == 0)
 			    {
 				match_ok = FALSE;
 				break;
@@ -789,7 +1289,7 @@ searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum)
 			    if (ptr[matchcol] == NUL
 				    || (nmatched = vim_regexec_multi(&regmatch,
 					      win, buf, lnum + matchpos.lnum,
-							      matchcol)) == 0)
+						      matchcol, budget)) == 0)
 				break;
 
 			    /* Need to get the line pointer again, a
@@ -864,7 +1364,8 @@ searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum)
 	     * twice.
 	     */
 	    if (!p_ws || stop_lnum != 0 || got_int || called_emsg
-					       || break_loop || found || loop)
+					       || break_loop || found || loop
+			    || (budget != NULL && budget->rb_timed_out))
 		break;
 
 	    /*
@@ -882,7 +1383,8 @@ searchit(win, buf, pos, dir, pat, count, options, pat_use, stop_lnum)
 		give_warning((char_u *)_(dir == BACKWARD
 					  ? top_bot_msg : bot_top_msg), TRUE);
 	}
-	if (got_int || called_emsg || break_loop)
+	if (got_int || called_emsg || break_loop
+				 || (budget != NULL && budget->rb_timed_out))
 	    break;
     }
     while (--count > 0 && found);   /* stop after count matches or no match */
@@ -960,6 +1462,7 @@ first_submatch(rp)
  *    If 'options & SEARCH_KEEP': keep previous search pattern
  *    If 'options & SEARCH_START': accept match at curpos itself
  *    If 'options & SEARCH_PEEK': check for typed char, cancel search
+ *    If 'budget' is not NULL: give up when it's used up, see searchit()
  *
  * Careful: If spats[0].off.line == TRUE and spats[0].off.off == 0 this
  * makes the movement linewise without moving the match position.
@@ -967,12 +1470,13 @@ first_submatch(rp)
  * return 0 for failure, 1 for found, 2 for found and line offset added
  */
     int
-do_search(oap, dirc, pat, count, options)
+do_search(oap, dirc, pat, count, options, budget)
     oparg_T	    *oap;	/* can be NULL */
     int		    dirc;	/* '/' or '?' */
     char_u	   *pat;
     long	    count;
     int		    options;
+    regbudget_T	    *budget;	/* limit for searching or NULL */
 {
     pos_T	    pos;	/* position of the last match */
     char_u	    *searchstr;
@@ -983,6 +1487,9 @@ do_search(oap, dirc, pat, count, options)
     char_u	    *dircp;
     char_u	    *strcopy = NULL;
     char_u	    *ps;
+#ifdef FEAT_SEARCH_EXTRA
+    int		    echo_col;	/* end of echoed pattern, -1 if none */
+#endif
 
     /*
      * A line offset is not remembered, this is vi compatible.
@@ -1053,6 +1560,9 @@ do_search(oap, dirc, pat, count, options)
      */
     for (;;)
     {
+#ifdef FEAT_SEARCH_EXTRA
+	echo_col = -1;
+#endif
 	searchstr = pat;
 	dircp = NULL;
 					    /* use previous pattern */
@@ -1196,6 +1706,9 @@ do_search(oap, dirc, pat, count, options)
 		msg_clr_eos();
 		msg_check();
 		vim_free(msgbuf);
+#ifdef FEAT_SEARCH_EXTRA
+		echo_col = msg_col;
+#endif
 
 		gotocmdline(FALSE);
 		out_flush();
@@ -1246,7 +1759,7 @@ do_search(oap, dirc, pat, count, options)
 		       (SEARCH_KEEP + SEARCH_PEEK + SEARCH_HIS
 			+ SEARCH_MSG + SEARCH_START
 			+ ((pat != NULL && *pat == ';') ? 0 : SEARCH_NOOF))),
-		RE_LAST, (linenr_T)0);
+		RE_LAST, (linenr_T)0, budget);
 
 	if (dircp != NULL)
 	    *dircp = dirc;	/* restore second '/' or '?' for normal_cmd() */
@@ -1260,6 +1773,13 @@ do_search(oap, dirc, pat, count, options)
 
 	retval = 1;		    /* pattern found */
 
+#ifdef FEAT_SEARCH_EXTRA
+	/* Show the number of the match after the echoed pattern. */
+	if (echo_col >= 0 && !(options & SEARCH_KEEP)
+					   && !shortmess(SHM_SEARCHCOUNT))
+	    search_idx_show(&pos, echo_col);
+#endif
+
 	/*
 	 * Add character and/or line offset
 	 */
@@ -2441,6 +2961,7 @@ findsent(dir, count)
     long	count;
 {
     pos_T	pos, tpos;
+    colnr_T	col;
     int		c;
     int		(*func) __ARGS((pos_T *));
     int		startlnum;
@@ -2518,6 +3039,17 @@ findsent(dir, count)
 		    ++pos.lnum;
 		break;
 	    }
+	    if (c != '.' && c != '!' && c != '?')
+	    {
+		/* Jump over the characters in between in one go, moving one
+		 * character at a time is slow for a long line. */
+		col = findsent_skip(ml_get(pos.lnum), pos.col, dir);
+		if (col != pos.col)
+		{
+		    pos.col = col;
+		    continue;
+		}
+	    }
 	    if (c == '.' || c == '!' || c == '?')
 	    {
 		tpos = pos;
@@ -2556,6 +3088,45 @@ found:
     return OK;
 }
 
+/*
+ * Return the column of the next '.', '!' or '?' in "line" after column "col"
+ * in direction "dir".  When there is none, the last character of the line
+ * when going forward and zero when going backward.
+ */
+    static colnr_T
+findsent_skip(line, col, dir)
+    char_u	*line;
+    colnr_T	col;
+    int		dir;
+{
+    char_u	*p = line + col;
+    char_u	*prev;
+
+    if (dir == FORWARD)
+    {
+	for (;;)
+	{
+	    prev = p;
+	    mb_ptr_adv(p);
+	    if (*p == NUL)
+	    {
+		p = prev;
+		break;
+	    }
+	    if (*p == '.' || *p == '!' || *p == '?')
+		break;
+	}
+    }
+    else
+	while (p > line)
+	{
+	    mb_ptr_back(line, p);
+	    if (*p == '.' || *p == '!' || *p == '?')
+		break;
+	}
+    return (colnr_T)(p - line);
+}
+
 /*
  * Find the next paragraph or section in direction 'dir'.
  * Paragraphs are currently supposed to be separated by empty lines.
@@ -2709,19 +3280,42 @@ startPS(lnum, para, both)
 
 static int	cls_bigword;	/* TRUE for "W", "B" or "E" */
 
+/*
+ * Class of an ASCII character, like cls_char() but faster.
+ */
+#define CLS_ASCII(c) ((c) == ' ' || (c) == '\t' || (c) == NUL ? 0 \
+			       : cls_bigword ? 1 : vim_iswordc(c) ? 2 : 1)
+
 /*
  * cls() - returns the class of character at curwin->w_cursor
+ */
+    static int
+cls()
+{
+    return cls_char(ml_get_cursor());
+}
+
+/*
+ * cls_char() - returns the class of the character at "p"
  *
  * If a 'W', 'B', or 'E' motion is being done (cls_bigword == TRUE), chars
  * from class 2 and higher are reported as class 1 since only white space
  * boundaries are of interest.
  */
     static int
-cls()
+cls_char(p)
+    char_u	*p;
 {
     int	    c;
 
-    c = gchar_cursor();
+    if (*p < 0x80)
+	return CLS_ASCII(*p);
+#ifdef FEAT_MBYTE
+    if (has_mbyte)
+	c = (*mb_ptr2char)(p);
+    else
+#endif
+	c = *p;
 #ifdef FEAT_FKMAP	/* when 'akm' (Farsi mode), take care of Farsi blank */
     if (p_altkeymap && c == F_BLANK)
 	return 0;
@@ -2756,6 +3350,73 @@ cls()
     return 1;
 }
 
+/*
+ * Move the cursor forward over characters of class "cclass", like calling
+ * inc_cursor() while cls() returns "cclass", but stay in the line: stops at
+ * the NUL.  ASCII characters are classified inline.
+ */
+    static void
+cls_fwd(cclass)
+    int		cclass;
+{
+    char_u	*line = ml_get_curline();
+    char_u	*p = line + curwin->w_cursor.col;
+
+    while (*p != NUL)
+    {
+	if (*p < 0x80)
+	{
+	    if (CLS_ASCII(*p) != cclass)
+		break;
+	    ++p;
+	}
+	else
+	{
+	    if (cls_char(p) != cclass)
+		break;
+	    mb_ptr_adv(p);
+	}
+    }
+    curwin->w_cursor.col = (colnr_T)(p - line);
+}
+
+/*
+ * Move the cursor back to the first character of the run of characters of
+ * class "cclass" it is in, without leaving the line.
+ */
+    static void
+cls_bck(cclass)
+    int		cclass;
+{
+    char_u	*line = ml_get_curline();
+    char_u	*p = line + curwin->w_cursor.col;
+    char_u	*prev;
+
+    while (p > line)
+    {
+	prev = p - 1;
+	/* In a double-byte encoding a trail byte may look like ASCII. */
+	if (*prev < 0x80
+#ifdef FEAT_MBYTE
+		&& enc_dbcs == 0
+#endif
+		)
+	{
+	    if (CLS_ASCII(*prev) != cclass)
+		break;
+	}
+	else
+	{
+	    prev = p;
+	    mb_ptr_back(line, prev);
+	    if (cls_char(prev) != cclass)
+		break;
+	}
+	p = prev;
+    }
+    curwin->w_cursor.col = (colnr_T)(p - line);
+}
+
 
 /*
  * fwd_word(count, type, eol) - move forward one word
@@ -2801,13 +3462,12 @@ fwd_word(count, bigword, eol)
 	/*
 	 * Go one char past end of current word (if any)
 	 */
-	if (sclass != 0)
-	    while (cls() == sclass)
-	    {
-		i = inc_cursor();
-		if (i == -1 || (i >= 1 && eol && count == 0))
-		    return OK;
-	    }
+	if (sclass != 0 && cls() == sclass)
+	{
+	    cls_fwd(sclass);
+	    if (eol && count == 0 && gchar_cursor() == NUL)
+		return OK;
+	}
 
 	/*
 	 * go to next non-white
@@ -2997,11 +3657,11 @@ bckend_word(count, bigword, eol)
 	/*
 	 * Move backward to before the start of this word.
 	 */
-	if (sclass != 0)
+	if (sclass != 0 && cls() == sclass)
 	{
-	    while (cls() == sclass)
-		if ((i = dec_cursor()) == -1 || (eol && i == 1))
-		    return OK;
+	    cls_bck(sclass);
+	    if ((i = dec_cursor()) == -1 || (eol && i == 1))
+		return OK;
 	}
 
 	/*
@@ -3028,8 +3688,19 @@ skip_chars(cclass, dir)
     int		dir;
 {
     while (cls() == cclass)
+    {
+	/* Skip the rest of the row in this line at once. */
+	if (dir == FORWARD)
+	{
+	    cls_fwd(cclass);
+	    if (cls() != cclass)
+		break;
+	}
+	else
+	    cls_bck(cclass);
 	if ((dir == FORWARD ? inc_cursor() : dec_cursor()) == -1)
 	    return TRUE;
+    }
     return FALSE;
 }
 
@@ -3040,20 +3711,7 @@ skip_chars(cclass, dir)
     static void
 back_in_line()
 {
-    int		sclass;		    /* starting class */
-
-    sclass = cls();
-    for (;;)
-    {
-	if (curwin->w_cursor.col == 0)	    /* stop at start of line */
-	    break;
-	dec_cursor();
-	if (cls() != sclass)		    /* stop at start of word */
-	{
-	    inc_cursor();
-	    break;
-	}
-    }
+    cls_bck(cls());
 }
 
     static void
@@ -4451,6 +5109,10 @@ find_pattern_in_path(ptr, dir, len, whole, skip_comments,
     char_u	*already = NULL;
     char_u	*startp = NULL;
     char_u	*inc_opt = NULL;
+    char_u	*incl_sig = NULL;
+    int		incl_skip = FALSE;
+    inclfile_T	*ifp;
+    inclline_T	*il;
 #ifdef RISCOS
     int		previous_munging = __riscosify_control;
 #endif
@@ -4497,6 +5159,7 @@ find_pattern_in_path(ptr, dir, len, whole, skip_comments,
 	if (incl_regmatch.regprog == NULL)
 	    goto fpip_end;
 	incl_regmatch.rm_ic = FALSE;	/* don't ignore case in incl. pat. */
+	incl_sig = incl_cache_sig(inc_opt);
     }
     if (type == FIND_DEFINE && (*curbuf->b_p_def != NUL || *p_def != NUL))
     {
@@ -4510,6 +5173,28 @@ find_pattern_in_path(ptr, dir, len, whole, skip_comments,
 			       (max_path_depth * sizeof(SearchedFile)), TRUE);
     if (files == NULL)
 	goto fpip_end;
+
+    /* When looking for a whole word, lines of an included file that doesn't
+     * contain the word can be skipped, only its 'include' lines matter.
+     * Case is ignored for ASCII letters only. */
+    if (incl_sig != NULL && action != ACTION_EXPAND)
+    {
+	if (type == CHECK_PATH)
+	    incl_skip = TRUE;
+	else if (whole && len > 0
+		&& (type == FIND_DEFINE || regmatch.regprog != NULL))
+	{
+	    incl_skip = TRUE;
+	    for (i = 0; i < len; i += (*mb_ptr2len)(ptr + i))
+		if (!vim_iswordp(ptr + i) || (ptr[i] >= 0x80
+			    && (regmatch.regprog != NULL ? regmatch.rm_ic
+								   : p_ic)))
+		{
+		    incl_skip = FALSE;
+		    break;
+		}
+	}
+    }
     old_files = max_path_depth;
     depth = depth_displayed = -1;
 
@@ -4528,7 +5213,29 @@ find_pattern_in_path(ptr, dir, len, whole, skip_comments,
 	    char_u *p_fname = (curr_fname == curbuf->b_fname)
 					      ? curbuf->b_ffname : curr_fname;
 
-	    if (inc_opt != NULL && strstr((char *)inc_opt, "\\zs") != NULL)
+	    /* Use the file name found before when it still exists.  A file
+	     * added in a directory in 'path' drops the cache entry. */
+	    il = NULL;
+	    if (depth >= 0 && files[depth].incl != NULL
+						     && !files[depth].building)
+	    {
+		SearchedFile *sf = &files[depth];
+
+		il = (inclline_T *)sf->incl->if_lines.ga_data;
+		while (sf->incl_idx < sf->incl->if_lines.ga_len
+				      && il[sf->incl_idx].il_lnum < sf->lnum)
+		    ++sf->incl_idx;
+		if (sf->incl_idx < sf->incl->if_lines.ga_len
+			&& il[sf->incl_idx].il_lnum == sf->lnum
+			&& il[sf->incl_idx].il_fname != NULL
+			&& mch_getperm(il[sf->incl_idx].il_fname) >= 0)
+		    il += sf->incl_idx++;
+		else
+		    il = NULL;
+	    }
+	    if (il != NULL)
+		new_fname = vim_strsave(il->il_fname);
+	    else if (inc_opt != NULL && strstr((char *)inc_opt, "\\zs") != NULL)
 		/* Use text from '\zs' to '\ze' (or end) of 'include'. */
 		new_fname = find_file_name_in_path(incl_regmatch.startp[0],
 			      (int)(incl_regmatch.endp[0] - incl_regmatch.startp[0]),
@@ -4537,6 +5244,22 @@ find_pattern_in_path(ptr, dir, len, whole, skip_comments,
 		/* Use text after match with 'include'. */
 		new_fname = file_name_in_line(incl_regmatch.endp[0], 0,
 			     FNAME_EXP|FNAME_INCL|FNAME_REL, 1L, p_fname, NULL);
+
+	    /* Remember the file name when filling the cache. */
+	    if (depth >= 0 && files[depth].building
+		    && ga_grow(&files[depth].incl->if_lines, 1) == OK)
+	    {
+		il = (inclline_T *)files[depth].incl->if_lines.ga_data
+				       + files[depth].incl->if_lines.ga_len++;
+		il->il_lnum = files[depth].lnum;
+		il->il_offset = files[depth].offset;
+		/* The name can only be used again when it's known that the
+		 * directories didn't change. */
+		il->il_fname = new_fname == NULL
+				     || !files[depth].incl->if_dirs_ok ? NULL
+						     : vim_strsave(new_fname);
+	    }
+
 	    already_searched = FALSE;
 	    if (new_fname != NULL)
 	    {
@@ -4663,6 +5386,9 @@ find_pattern_in_path(ptr, dir, len, whole, skip_comments,
 			    bigger[i].name = NULL;
 			    bigger[i].lnum = 0;
 			    bigger[i].matched = FALSE;
+			    bigger[i].incl = NULL;
+			    bigger[i].building = FALSE;
+			    bigger[i].skip = FALSE;
 			}
 			for (i = old_files; i < max_path_depth; i++)
 			    bigger[i + max_path_depth] = files[i];
@@ -4689,6 +5415,31 @@ find_pattern_in_path(ptr, dir, len, whole, skip_comments,
 		    files[depth].name = curr_fname = new_fname;
 		    files[depth].lnum = 0;
 		    files[depth].matched = FALSE;
+		    files[depth].incl = NULL;
+		    files[depth].building = FALSE;
+		    files[depth].skip = FALSE;
+		    files[depth].incl_idx = 0;
+		    if (incl_sig != NULL)
+		    {
+			ifp = incl_cache_find(new_fname, incl_sig);
+			if (ifp != NULL)
+			{
+			    files[depth].incl = ifp;
+			    files[depth].skip = incl_skip
+				&& (type == CHECK_PATH
+				    || (((regmatch.regprog != NULL
+						    ? !regmatch.rm_ic : !p_ic)
+					    || !ifp->if_nonascii)
+					&& !incl_cache_has_word(ifp, ptr,
+								       len)));
+			}
+			else if (action != ACTION_EXPAND)
+			{
+			    files[depth].incl = incl_cache_new(new_fname,
+								    incl_sig);
+			    files[depth].building = files[depth].incl != NULL;
+			}
+		    }
 #ifdef FEAT_INS_EXPAND
 		    if (action == ACTION_EXPAND)
 		    {
@@ -5030,8 +5781,16 @@ exit_matched:
 	 * it.
 	 */
 	while (depth >= 0 && !already
-		&& vim_fgets(line = file_line, LSIZE, files[depth].fp))
+		&& incl_fgets(&files[depth], line = file_line))
 	{
+	    if (files[depth].building)
+	    {
+		/* Lines read by show_pat_in_path() were not seen. */
+		if (files[depth].incl->if_lnum == files[depth].lnum)
+		    incl_cache_add(files[depth].incl);
+		else
+		    incl_cache_free(files[depth].incl);
+	    }
 	    fclose(files[depth].fp);
 	    --old_files;
 	    files[old_files].name = files[depth].name;
@@ -5059,10 +5818,13 @@ exit_matched:
     {
 	fclose(files[i].fp);
 	vim_free(files[i].name);
+	if (files[i].building)
+	    incl_cache_free(files[i].incl);
     }
     for (i = old_files; i < max_path_depth; i++)
 	vim_free(files[i].name);
     vim_free(files);
+    incl_cache_trim();
 
     if (type == CHECK_PATH)
     {
@@ -5096,6 +5858,7 @@ exit_matched:
 
 fpip_end:
     vim_free(file_line);
+    vim_free(incl_sig);
     vim_free(regmatch.regprog);
     vim_free(incl_regmatch.regprog);
     vim_free(def_regmatch.regprog);
@@ -5106,6 +5869,339 @@ fpip_end:
 #endif
 }
 
+/*
+ * Return the options that find_pattern_in_path() uses for finding included
+ * files and identifiers, in allocated memory.  Information in "incl_cache"
+ * is only used when they didn't change.  Returns NULL when the cache can't
+ * be used, e.g. because 'includeexpr' is set.
+ */
+    static char_u *
+incl_cache_sig(inc_opt)
+    char_u	*inc_opt;
+{
+    garray_T	ga;
+    char_u	*opts[6];
+    int		i;
+
+#ifdef FEAT_EVAL
+    if (*curbuf->b_p_inex != NUL)
+	return NULL;
+#endif
+    if (mch_dirname(NameBuff, MAXPATHL) == FAIL)
+	return NULL;
+    opts[0] = inc_opt;
+    opts[1] = *curbuf->b_p_path == NUL ? p_path : curbuf->b_p_path;
+    opts[2] = p_isf;
+    opts[3] = curbuf->b_p_isk;
+    opts[4] = NameBuff;
+#ifdef FEAT_SEARCHPATH
+    opts[5] = curbuf->b_p_sua;
+#else
+    opts[5] = (char_u *)"";
+#endif
+
+    ga_init2(&ga, 1, 200);
+    for (i = 0; i < 6; ++i)
+    {
+	ga_concat(&ga, opts[i]);
+	ga_append(&ga, '\n');
+    }
+    ga_append(&ga, NUL);
+    return (char_u *)ga.ga_data;
+}
+
+/*
+ * Compute a value from the modification times of the directories in 'path',
+ * as used for files included by "fname", in "*stampp".  Creating or deleting
+ * a file in one of them changes it, a file name found before may then be
+ * different.  Returns FAIL when 'path' uses "*" or ";", the directories
+ * searched are not known then.
+ */
+    static int
+incl_dir_stamp(fname, stampp)
+    char_u	*fname;
+    long_u	*stampp;
+{
+    char_u	*path = *curbuf->b_p_path == NUL ? p_path : curbuf->b_p_path;
+    char_u	*buf;
+    int		len;
+    int		retval = OK;
+    struct stat	st;
+
+    buf = alloc(MAXPATHL);
+    if (buf == NULL)
+	return FAIL;
+    *stampp = 0;
+    while (*path != NUL)
+    {
+	/* "." and "./dir" are relative to the directory of "fname". */
+	len = 0;
+	if (path[0] == '.' && (path[1] == NUL || path[1] == ','
+						 || vim_ispathsep(path[1])))
+	{
+	    len = (int)(gettail(fname) - fname);
+	    if (len >= MAXPATHL - 1)
+		len = 0;
+	    mch_memmove(buf, fname, (size_t)len);
+	    ++path;
+	}
+	copy_option_part(&path, buf + len, MAXPATHL - len, ",");
+	if (vim_strpbrk(buf, (char_u *)"*;") != NULL)
+	{
+	    retval = FAIL;
+	    break;
+	}
+	if (*buf == NUL)
+	    STRCPY(buf, ".");
+	*stampp *= 31;
+	if (mch_stat((char *)buf, &st) == 0)
+	    *stampp += (long_u)st.st_mtime;
+    }
+    vim_free(buf);
+    return retval;
+}
+
+/*
+ * Find the cached information for file "fname", scanned with options "sig".
+ * Returns NULL when there is none or when the file has changed.
+ */
+    static inclfile_T *
+incl_cache_find(fname, sig)
+    char_u	*fname;
+    char_u	*sig;
+{
+    inclfile_T	*ifp;
+    inclfile_T	**pp;
+    struct stat	st;
+    long_u	stamp;
+
+    for (pp = &incl_cache; *pp != NULL; pp = &(*pp)->if_next)
+	if (fnamecmp((*pp)->if_name, fname) == 0)
+	    break;
+    ifp = *pp;
+    if (ifp == NULL)
+	return NULL;
+
+    /* Remove it from the list, it's put back in front when still valid. */
+    *pp = ifp->if_next;
+    --incl_cache_len;
+    if (mch_stat((char *)fname, &st) < 0
+	    || (long)st.st_size != ifp->if_size
+	    || st.st_mtime != ifp->if_mtime
+	    || STRCMP(sig, ifp->if_sig) != 0
+	    || (ifp->if_dirs_ok && (incl_dir_stamp(fname, &stamp) == FAIL
+					      || stamp != ifp->if_dirstamp)))
+    {
+	incl_cache_free(ifp);
+	return NULL;
+    }
+    ifp->if_next = incl_cache;
+    incl_cache = ifp;
+    ++incl_cache_len;
+    return ifp;
+}
+
+/*
+ * Allocate an entry for file "fname" to be filled while reading it.
+ * Returns NULL when out of memory or the file can't be found.
+ */
+    static inclfile_T *
+incl_cache_new(fname, sig)
+    char_u	*fname;
+    char_u	*sig;
+{
+    inclfile_T	*ifp;
+    struct stat	st;
+    long_u	bits;
+
+    if (mch_stat((char *)fname, &st) < 0)
+	return NULL;
+    ifp = (inclfile_T *)alloc_clear((unsigned)sizeof(inclfile_T));
+    if (ifp == NULL)
+	return NULL;
+    ifp->if_size = (long)st.st_size;
+    ifp->if_mtime = st.st_mtime;
+    ifp->if_dirs_ok = incl_dir_stamp(fname, &ifp->if_dirstamp) == OK;
+    ga_init2(&ifp->if_lines, (int)sizeof(inclline_T), 20);
+
+    /* There are fewer identifiers than a quarter of the number of bytes,
+     * with eight bits per identifier few lookups give a false positive. */
+    for (bits = 1024; bits < (long_u)ifp->if_size * 2 && bits < 0x100000L;
+								    bits *= 2)
+	;
+    ifp->if_wordmask = bits - 1;
+    ifp->if_name = vim_strsave(fname);
+    ifp->if_sig = vim_strsave(sig);
+    ifp->if_words = alloc_clear((unsigned)(bits / 8));
+    if (ifp->if_name == NULL || ifp->if_sig == NULL || ifp->if_words == NULL)
+    {
+	incl_cache_free(ifp);
+	return NULL;
+    }
+    return ifp;
+}
+
+/*
+ * Add a completely filled entry to the cache.
+ */
+    static void
+incl_cache_add(ifp)
+    inclfile_T	*ifp;
+{
+    ifp->if_next = incl_cache;
+    incl_cache = ifp;
+    ++incl_cache_len;
+}
+
+/*
+ * Drop the least recently used entries when there are too many.  Not done in
+ * incl_cache_add(), entries may still be in use then.
+ */
+    static void
+incl_cache_trim()
+{
+    inclfile_T	**pp;
+    inclfile_T	*ifp;
+    int		n = 0;
+
+    if (incl_cache_len <= INCL_CACHE_MAX)
+	return;
+    for (pp = &incl_cache; n < INCL_CACHE_MAX; pp = &(*pp)->if_next)
+	++n;
+    while (*pp != NULL)
+    {
+	ifp = *pp;
+	*pp = ifp->if_next;
+	incl_cache_free(ifp);
+    }
+    incl_cache_len = INCL_CACHE_MAX;
+}
+
+    static void
+incl_cache_free(ifp)
+    inclfile_T	*ifp;
+{
+    int		i;
+
+    for (i = 0; i < ifp->if_lines.ga_len; ++i)
+	vim_free(((inclline_T *)ifp->if_lines.ga_data)[i].il_fname);
+    ga_clear(&ifp->if_lines);
+    vim_free(ifp->if_name);
+    vim_free(ifp->if_sig);
+    vim_free(ifp->if_words);
+    vim_free(ifp);
+}
+
+/*
+ * Hash the identifier "p[len]", ignoring case of ASCII letters.
+ */
+    static long_u
+incl_word_hash(p, len)
+    char_u	*p;
+    int		len;
+{
+    long_u	hash = 0;
+    int		i;
+
+    for (i = 0; i < len; ++i)
+	hash = hash * 101 + TOLOWER_ASC(p[i]);
+    return hash;
+}
+
+/*
+ * Add the identifiers in "line" to the Bloom filter of "ifp".  Each sets two
+ * bits.
+ */
+    static void
+incl_cache_words(ifp, line)
+    inclfile_T	*ifp;
+    char_u	*line;
+{
+    char_u	*p = line;
+    char_u	*start;
+    long_u	hash;
+    long_u	bit;
+
+    while (*p != NUL)
+    {
+	if (!vim_iswordp(p))
+	{
+	    mb_ptr_adv(p);
+	    continue;
+	}
+	start = p;
+	while (*p != NUL && vim_iswordp(p))
+	{
+	    if (*p >= 0x80)
+		ifp->if_nonascii = TRUE;
+	    mb_ptr_adv(p);
+	}
+	hash = incl_word_hash(start, (int)(p - start));
+	bit = hash & ifp->if_wordmask;
+	ifp->if_words[bit >> 3] |= 1 << (bit & 7);
+	bit = (hash >> 13) & ifp->if_wordmask;
+	ifp->if_words[bit >> 3] |= 1 << (bit & 7);
+    }
+}
+
+/*
+ * Return FALSE when identifier "word[len]" certainly isn't in the file of
+ * "ifp", ignoring case.
+ */
+    static int
+incl_cache_has_word(ifp, word, len)
+    inclfile_T	*ifp;
+    char_u	*word;
+    int		len;
+{
+    long_u	hash = incl_word_hash(word, len);
+    long_u	bit;
+
+    bit = hash & ifp->if_wordmask;
+    if (!(ifp->if_words[bit >> 3] & (1 << (bit & 7))))
+	return FALSE;
+    bit = (hash >> 13) & ifp->if_wordmask;
+    return (ifp->if_words[bit >> 3] & (1 << (bit & 7))) != 0;
+}
+
+/*
+ * Read the next line of included file "sf" into "buf", like vim_fgets().
+ * When "sf->skip" is set go to the next line that matches 'include', the
+ * other lines can't contain what is being searched for.
+ * Returns TRUE for end-of-file.
+ */
+    static int
+incl_fgets(sf, buf)
+    SearchedFile	*sf;
+    char_u		*buf;
+{
+    inclline_T	*il;
+
+    if (sf->skip)
+    {
+	il = (inclline_T *)sf->incl->if_lines.ga_data;
+	while (sf->incl_idx < sf->incl->if_lines.ga_len
+				       && il[sf->incl_idx].il_lnum <= sf->lnum)
+	    ++sf->incl_idx;
+	if (sf->incl_idx >= sf->incl->if_lines.ga_len)
+	    return TRUE;
+	il += sf->incl_idx;
+	if (fseek(sf->fp, il->il_offset, SEEK_SET) != 0)
+	    return TRUE;
+	sf->lnum = il->il_lnum - 1;
+    }
+    if (sf->building)
+	sf->offset = ftell(sf->fp);
+    if (vim_fgets(buf, LSIZE, sf->fp))
+	return TRUE;
+    if (sf->building)
+    {
+	incl_cache_words(sf->incl, buf);
+	++sf->incl->if_lnum;
+    }
+    return FALSE;
+}
+
     static void
 show_pat_in_path(line, type, did_show, action, fp, lnum, count)
     char_u  *line;
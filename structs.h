@@ -559,6 +559,8 @@ typedef struct memline
     chunksize_T *ml_chunksize;
     int		ml_numchunks;
     int		ml_usedchunks;
+    linenr_T	ml_hintline;	/* first line of chunk "ml_hintix" */
+    int		ml_hintix;	/* chunk to start a search at */
 #endif
 } memline_T;
 
@@ -1122,6 +1124,55 @@ struct dictvar_S
 typedef struct qf_info_S qf_info_T;
 #endif
 
+#ifdef FEAT_SEARCH_EXTRA
+/*
+ * Index of the matches of the last used search pattern in a buffer, used for
+ * 'hlsearch' and for showing the match count.  Only patterns that match
+ * within one line and depend on nothing but its text are indexed.
+ * si_count[lnum - 1] is the number of matches that start in line "lnum", as
+ * they are found by "n", or SI_UNKNOWN when the line was not scanned yet.
+ * Changed lines are set back to SI_UNKNOWN by changed_common().
+ */
+typedef struct
+{
+    char_u	*si_pat;	/* pattern the index is for, NULL if none */
+    int		si_magic;	/* "magic" of the pattern */
+    int		si_no_scs;	/* "no_scs" of the pattern */
+    int		si_ic;		/* 'ignorecase' when compiled */
+    int		si_scs;		/* 'smartcase' when compiled */
+    int		si_cpo_search;	/* 'c' in 'cpoptions' when compiled */
+    char_u	si_chartab[32];	/* b_chartab ('iskeyword') when compiled */
+    int		si_chartab_tick; /* chartab_tick when compiled */
+    regmmatch_T	si_regmatch;	/* compiled pattern */
+    int		*si_count;	/* nr of matches per line, NULL when the
+				   pattern can't be indexed */
+    linenr_T	si_len;		/* nr of entries in si_count[] */
+    linenr_T	si_unknown;	/* nr of SI_UNKNOWN entries in si_count[] */
+    linenr_T	si_next;	/* line where scanning continues */
+} searchidx_T;
+
+# define SI_UNKNOWN	(-1)
+#endif
+
+#ifdef FEAT_SYN_HL
+/*
+ * Statistics kept by ":syntime" for a syntax pattern.  The cost is the time
+ * used with the +profile feature, otherwise the number of regexp steps.
+ */
+typedef struct
+{
+# ifdef FEAT_PROFILE
+    proftime_T	total;		/* total time used */
+    proftime_T	slowest;	/* time of the slowest call */
+# else
+    long	total;		/* total nr of steps */
+    long	slowest;	/* nr of steps of the slowest call */
+# endif
+    long	count;		/* nr of times tried */
+    long	match;		/* nr of times it matched */
+} syn_time_T;
+#endif
+
 /*
  * buffer: structure that holds information about one file
  *
@@ -1513,7 +1564,16 @@ struct file_buffer
 #ifdef FEAT_SYN_HL
     hashtab_T	b_keywtab;		/* syntax keywords hash table */
     hashtab_T	b_keywtab_ic;		/* idem, ignore case */
+    char_u	b_keywfilter[KEYW_FILTER_SIZE / 8]; /* bits for the length
+					   and first and last byte of
+					   keywords in both tables */
+    int		b_keywfilter_ok;	/* b_keywfilter[] is valid */
+    syn_time_T	b_syn_keyw_time;	/* ":syntime" for keywords */
+    int		b_syn_linelocal;	/* TRUE when patterns only use
+					   the text of the line, MAYBE when
+					   not checked yet */
     int		b_syn_error;		/* TRUE when error occured in HL */
+    int		b_syn_slow;		/* TRUE when HL was too slow */
     int		b_syn_ic;		/* ignore case for :syn cmds */
     int		b_syn_spell;		/* SYNSPL_ values */
     garray_T	b_syn_patterns;		/* table for syntax patterns */
@@ -1567,6 +1627,10 @@ struct file_buffer
 # endif
 #endif
 
+#ifdef FEAT_SEARCH_EXTRA
+    searchidx_T	b_search_idx;	/* matches of last search pattern */
+#endif
+
 #ifdef FEAT_SIGNS
     signlist_T	*b_signlist;	/* list of signs to draw */
 #endif
@@ -1666,6 +1730,31 @@ typedef struct w_line
 #endif
 } wline_T;
 
+/*
+ * Cache of the number of screen lines that buffer lines use in a window, see
+ * plines_win_nofold().  An entry is found by "lnum % PLC_SIZE".  All entries
+ * are for one buffer, one value of b_changedtick, the text width of the
+ * window and the option values below; when one of these differs the cache is
+ * cleared.  Changed lines are removed by changed_common().  Setting a global
+ * option that may change the height of lines clears the cache of all windows.
+ */
+#define PLC_SIZE	256
+
+typedef struct
+{
+    int		plc_fnum;	    /* b_fnum of the buffer, 0 if empty */
+    int		plc_changedtick;    /* b_changedtick of the buffer */
+    int		plc_width;	    /* W_WIDTH() - win_col_off() */
+    int		plc_off2;	    /* win_col_off2() */
+    long	plc_ts;		    /* 'tabstop' */
+    int		plc_list;	    /* 'list' */
+#ifdef FEAT_LINEBREAK
+    int		plc_lbr;	    /* 'linebreak' */
+#endif
+    linenr_T	plc_lnum[PLC_SIZE]; /* line number, 0 for unused entry */
+    int		plc_lines[PLC_SIZE]; /* nr of screen lines of plc_lnum[] */
+} plines_cache_T;
+
 /*
  * Windows are kept in a tree of frames.  Each frame has a column (FR_COL)
  * or row (FR_ROW) layout or is a leaf, which has a window.
@@ -1831,6 +1920,8 @@ struct window_S
      */
     int		w_lines_valid;	    /* number of valid entries */
     wline_T	*w_lines;
+    plines_cache_T *w_plines_cache; /* line heights, NULL when not
+				       allocated yet */
 
 #ifdef FEAT_FOLDING
     garray_T	w_folds;	    /* array of nested folds */
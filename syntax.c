@@ -80,7 +80,27 @@ static char *(hl_name_table[]) =
 static int hl_attr_table[] =
     {HL_BOLD, HL_STANDOUT, HL_UNDERLINE, HL_UNDERCURL, HL_ITALIC, HL_INVERSE, HL_INVERSE, 0};
 
+/*
+ * Index to find an entry in an attribute table from its specifications.
+ * ah_idx[] holds the table index plus one, zero for an unused slot.  A slot
+ * is found with linear probing from the hash of the entry.  The index is
+ * kept less than half full.
+ */
+typedef struct
+{
+    int		*ah_idx;	/* allocated array of ah_size items */
+    int		ah_size;	/* power of two, zero when not used */
+} attrhash_T;
+
 static int get_attr_entry  __ARGS((garray_T *table, attrentry_T *aep));
+static attrhash_T *attr_table_hash __ARGS((garray_T *table));
+static unsigned attr_entry_hash __ARGS((garray_T *table, attrentry_T *aep));
+static int attr_entry_equal __ARGS((garray_T *table, attrentry_T *aep, attrentry_T *taep));
+static int attr_hash_slot __ARGS((garray_T *table, attrhash_T *ahp, attrentry_T *aep));
+static int attr_hash_room __ARGS((garray_T *table, attrhash_T *ahp));
+#if defined(FEAT_SYN_HL) || defined(FEAT_SPELL)
+static int hl_new_combined_attr __ARGS((int char_attr, int prim_attr));
+#endif
 static void syn_unadd_group __ARGS((void));
 static void set_hl_attr __ARGS((int idx));
 static void highlight_list_one __ARGS((int id));
@@ -151,6 +171,7 @@ typedef struct syn_pattern
     int		 sp_sync_idx;		/* sync item index (syncing only) */
     int		 sp_line_id;		/* ID of last line where tried */
     int		 sp_startcol;		/* next match in sp_line_id line */
+    syn_time_T	 sp_time;		/* ":syntime" statistics */
 } synpat_T;
 
 /* The sp_off_flags are computed like this:
@@ -348,6 +369,8 @@ static reg_extmatch_T *next_match_extmatch = NULL;
  */
 static win_T	*syn_win;		/* current window for highlighting */
 static buf_T	*syn_buf;		/* current buffer for highlighting */
+static regbudget_T *syn_budget = NULL;	/* limit for matching, or NULL */
+static int	syn_time_on = FALSE;	/* ":syntime on" was used */
 static linenr_T current_lnum = 0;	/* lnum of current state */
 static colnr_T	current_col = 0;	/* column of current state */
 static int	current_state_stored = 0; /* TRUE if stored current state
@@ -361,7 +384,46 @@ static int	current_line_id = 0;	/* unique number for current line */
 
 #define CUR_STATE(idx)	((stateitem_T *)(current_state.ga_data))[idx]
 
+/*
+ * Lines that were drawn are remembered in syn_line_cache[], with the
+ * attributes for each run of columns and the states at the start and end of
+ * the line.  When a line with the same text is drawn again starting in the
+ * same state, the attributes are used without matching any pattern.  When a
+ * pattern may look at other lines the line number and b_changedtick must
+ * match as well.  See syntax_start_draw().  Long lines are not cached, they
+ * are often not drawn up to the end.
+ */
+typedef struct
+{
+    colnr_T	sr_col;		/* first column of the run */
+    int		sr_attr;	/* attributes for the run */
+    int		sr_spell;	/* can_spell for the run */
+} synrun_T;
+
+typedef struct
+{
+    buf_T	*sl_buf;	/* buffer, NULL when not valid */
+    linenr_T	sl_lnum;	/* line number in sl_buf */
+    int		sl_changedtick;	/* b_changedtick of sl_buf */
+    char_u	*sl_line;	/* allocated copy of the text */
+    char_u	sl_chartab[32];	/* b_chartab of sl_buf */
+    int		sl_chartab_tick; /* chartab_tick, for "\i" and "\f" */
+    synstate_T	sl_start;	/* state at start of the line */
+    synstate_T	sl_end;		/* state at end of the line */
+    garray_T	sl_runs;	/* synrun_T items */
+} synline_T;
+
+#define SYN_LINE_CACHE	128	/* nr of entries in syn_line_cache[] */
+#define SYN_LINE_MAXLEN	1000	/* longer lines are not cached */
+
+static synline_T syn_line_cache[SYN_LINE_CACHE];
+static synline_T *syn_line_rec = NULL;	/* entry for line being drawn */
+static synline_T *syn_line_play = NULL;	/* entry being replayed */
+static int	syn_line_play_idx = 0;	/* current run in syn_line_play */
+
+static int syntax_advance __ARGS((win_T *wp, linenr_T lnum));
 static void syn_sync __ARGS((win_T *wp, linenr_T lnum, synstate_T *last_valid));
+static linenr_T syn_sync_back __ARGS((void));
 static int syn_match_linecont __ARGS((linenr_T lnum));
 static void syn_start_line __ARGS((void));
 static void syn_update_ends __ARGS((int startofline));
@@ -370,6 +432,12 @@ static int syn_stack_cleanup __ARGS((void));
 static void syn_stack_free_entry __ARGS((buf_T *buf, synstate_T *p));
 static synstate_T *syn_stack_find_entry __ARGS((linenr_T lnum));
 static synstate_T *store_current_state __ARGS((synstate_T *sp));
+static int can_save_current_state __ARGS((linenr_T lnum));
+static void save_current_state __ARGS((synstate_T *sp));
+static void syn_line_record __ARGS((int attr, int spell));
+static int syn_line_replay __ARGS((colnr_T col, int *can_spell));
+static void syn_line_cache_clear __ARGS((void));
+static int syn_patterns_linelocal __ARGS((void));
 static void load_current_state __ARGS((synstate_T *from));
 static void invalidate_current_state __ARGS((void));
 static int syn_stack_equal __ARGS((synstate_T *sp));
@@ -396,7 +464,8 @@ static void limit_pos_zero __ARGS((lpos_T *pos, lpos_T *limit));
 static void syn_add_end_off __ARGS((lpos_T *result, regmmatch_T *regmatch, synpat_T *spp, int idx, int extra));
 static void syn_add_start_off __ARGS((lpos_T *result, regmmatch_T *regmatch, synpat_T *spp, int idx, int extra));
 static char_u *syn_getcurline __ARGS((void));
-static int syn_regexec __ARGS((regmmatch_T *rmp, linenr_T lnum, colnr_T col));
+static int syn_regexec __ARGS((regmmatch_T *rmp, linenr_T lnum, colnr_T col, syn_time_T *st));
+static void keyw_filter_build __ARGS((buf_T *buf));
 static int check_keyword_id __ARGS((char_u *line, int startcol, int *endcol, long *flags, short **next_list, stateitem_T *cur_si));
 static void syn_cmd_case __ARGS((exarg_T *eap, int syncing));
 static void syn_cmd_spell __ARGS((exarg_T *eap, int syncing));
@@ -413,6 +482,16 @@ static void syn_cmd_manual __ARGS((exarg_T *eap, int syncing));
 static void syn_cmd_off __ARGS((exarg_T *eap, int syncing));
 static void syn_cmd_onoff __ARGS((exarg_T *eap, char *name));
 static void syn_cmd_list __ARGS((exarg_T *eap, int syncing));
+static void syntime_clear __ARGS((void));
+#ifdef __BORLANDC__
+static int _RTLENTRYF syntime_compare __ARGS((const void *v1, const void *v2));
+#else
+static int syntime_compare __ARGS((const void *v1, const void *v2));
+#endif
+static void syntime_report __ARGS((void));
+#ifndef FEAT_PROFILE
+static char *syntime_steps_msg __ARGS((long steps));
+#endif
 static void syn_lines_msg __ARGS((void));
 static void syn_match_msg __ARGS((void));
 static void syn_list_one __ARGS((int id, int syncing, int link_only));
@@ -457,6 +536,20 @@ static void syn_incl_toplevel __ARGS((int id, int *flagsp));
 syntax_start(wp, lnum)
     win_T	*wp;
     linenr_T	lnum;
+{
+    if (syntax_advance(wp, lnum) == OK)
+	syn_start_line();
+}
+
+/*
+ * Get current_state to the state at the start of line "lnum", before
+ * syn_start_line() is called for it.
+ * Returns FAIL when out of memory.
+ */
+    static int
+syntax_advance(wp, lnum)
+    win_T	*wp;
+    linenr_T	lnum;
 {
     synstate_T	*p;
     synstate_T	*last_valid = NULL;
@@ -467,6 +560,9 @@ syntax_start(wp, lnum)
     int		dist;
     static int	changedtick = 0;	/* remember the last change ID */
 
+    syn_line_rec = NULL;
+    syn_line_play = NULL;
+
     /*
      * After switching buffers, invalidate current_state.
      * Also do this when a change was made, the current state may be invalid
@@ -485,7 +581,7 @@ syntax_start(wp, lnum)
      */
     syn_stack_alloc();
     if (syn_buf->b_sst_array == NULL)
-	return;		/* out of memory */
+	return FAIL;	/* out of memory */
     syn_buf->b_sst_lasttick = display_tick;
 
     /*
@@ -533,6 +629,12 @@ syntax_start(wp, lnum)
 	}
 	if (last_min_valid != NULL)
 	    load_current_state(last_min_valid);
+	/* A saved state further back is still used when syn_sync() would
+	 * start parsing at or before it anyway: parsing forward from it takes
+	 * no longer and gives the exact state, which syncing may not. */
+	else if (last_valid != NULL
+			&& last_valid->sst_lnum + syn_sync_back() >= lnum)
+	    load_current_state(last_valid);
     }
 
     /*
@@ -610,8 +712,306 @@ syntax_start(wp, lnum)
 	    break;
 	}
     }
+    return OK;
+}
+
+/*
+ * Like syntax_start(), for drawing line "lnum" in window "wp" with
+ * get_syntax_attr().  When the line was drawn before, didn't change and
+ * starts in the same state, the attributes are taken from syn_line_cache[]
+ * and no pattern needs to be matched.  Otherwise the attributes are
+ * remembered while drawing.
+ */
+    void
+syntax_start_draw(wp, lnum)
+    win_T	*wp;
+    linenr_T	lnum;
+{
+    synline_T	*sl;
+    char_u	*line;
+    unsigned	hash;
+    int		i;
+
+    if (syntax_advance(wp, lnum) == FAIL)
+	return;
+    if (got_int || INVALID_STATE(&current_state))
+    {
+	syn_start_line();
+	return;
+    }
+
+    /* Only a state that could be stored in b_sst_array[] can be used to
+     * recognize the line: it doesn't depend on the previous lines.
+     * With ":syntime on" all lines are parsed, so that they are counted. */
+    if (!can_save_current_state(lnum) || syn_time_on)
+    {
+	syn_start_line();
+	return;
+    }
+    if (syn_buf->b_syn_linelocal == MAYBE)
+	syn_buf->b_syn_linelocal = syn_patterns_linelocal();
+
+    /* Find the entry from the text and the state. */
+    line = syn_getcurline();
+    hash = current_state.ga_len;
+    if (current_state.ga_len > 0)
+	hash += CUR_STATE(current_state.ga_len - 1).si_idx * 7;
+    for (i = 0; line[i] != NUL; ++i)
+    {
+	if (i == SYN_LINE_MAXLEN)
+	{
+	    syn_start_line();
+	    return;
+	}
+	hash = hash * 31 + line[i];
+    }
+    if (!syn_buf->b_syn_linelocal)
+	hash += lnum;
+    sl = &syn_line_cache[hash % SYN_LINE_CACHE];
+
+    if (sl->sl_buf == syn_buf
+	    && (syn_buf->b_syn_linelocal
+		|| (sl->sl_lnum == lnum
+		    && sl->sl_changedtick == syn_buf->b_changedtick))
+	    && STRCMP(sl->sl_line, line) == 0
+	    && vim_memcmp(sl->sl_chartab, syn_buf->b_chartab, 32) == 0
+	    && sl->sl_chartab_tick == chartab_tick
+	    && syn_stack_equal(&sl->sl_start))
+    {
+	/* Continue with the state at the end of the line, as if it was
+	 * parsed. */
+	load_current_state(&sl->sl_end);
+	current_lnum = lnum;
+	current_col = 0;
+	current_finished = TRUE;
+	current_state_stored = FALSE;
+	syn_line_play = sl;
+	syn_line_play_idx = 0;
+	return;
+    }
 
+    if (sl->sl_runs.ga_itemsize == 0)
+	ga_init2(&sl->sl_runs, (int)sizeof(synrun_T), 20);
+    sl->sl_runs.ga_len = 0;
+    sl->sl_buf = NULL;
+    sl->sl_lnum = lnum;
+    save_current_state(&sl->sl_start);
     syn_start_line();
+    syn_line_rec = sl;
+}
+
+/*
+ * Remember "attr" and "spell" for current_col of the line being drawn.
+ * When at the NUL make the cache entry valid.
+ */
+    static void
+syn_line_record(attr, spell)
+    int		attr;
+    int		spell;
+{
+    synline_T	*sl = syn_line_rec;
+    synrun_T	*run;
+
+    if (sl->sl_lnum != current_lnum)
+    {
+	syn_line_rec = NULL;
+	return;
+    }
+    if (sl->sl_runs.ga_len > 0)
+	run = (synrun_T *)sl->sl_runs.ga_data + sl->sl_runs.ga_len - 1;
+    if (sl->sl_runs.ga_len == 0
+	    || run->sr_attr != attr || run->sr_spell != spell)
+    {
+	if (ga_grow(&sl->sl_runs, 1) == FAIL)
+	{
+	    syn_line_rec = NULL;
+	    return;
+	}
+	run = (synrun_T *)sl->sl_runs.ga_data + sl->sl_runs.ga_len++;
+	run->sr_col = current_col;
+	run->sr_attr = attr;
+	run->sr_spell = spell;
+    }
+
+    /* Only a line that was drawn up to the NUL is complete, the text is
+     * only copied then.  After the NUL the attributes are zero, like
+     * syn_current_attr() returns. */
+    if (current_finished && syn_getcurline()[current_col] == NUL)
+    {
+	syn_line_rec = NULL;
+	vim_free(sl->sl_line);
+	sl->sl_line = vim_strsave(syn_getcurline());
+	if (sl->sl_line != NULL
+		&& can_save_current_state(current_lnum + 1)
+				       && ga_grow(&sl->sl_runs, 1) == OK)
+	{
+	    run = (synrun_T *)sl->sl_runs.ga_data + sl->sl_runs.ga_len++;
+	    run->sr_col = current_col + 1;
+	    run->sr_attr = 0;
+	    run->sr_spell = TRUE;
+	    save_current_state(&sl->sl_end);
+	    sl->sl_buf = syn_buf;
+	    sl->sl_changedtick = syn_buf->b_changedtick;
+	    mch_memmove(sl->sl_chartab, syn_buf->b_chartab, 32);
+	    sl->sl_chartab_tick = chartab_tick;
+	}
+    }
+}
+
+/*
+ * Get the attributes for column "col" of the line being replayed.
+ */
+    static int
+syn_line_replay(col, can_spell)
+    colnr_T	col;
+    int		*can_spell;
+{
+    synrun_T	*runs = (synrun_T *)syn_line_play->sl_runs.ga_data;
+    int		len = syn_line_play->sl_runs.ga_len;
+    int		i = syn_line_play_idx;
+
+    /* Like get_syntax_attr() without the cache: zero for a column before
+     * current_col. */
+    if (col < current_col)
+	return 0;
+    current_col = col + 1;
+    while (i + 1 < len && runs[i + 1].sr_col <= col)
+	++i;
+    syn_line_play_idx = i;
+    if (can_spell != NULL)
+	*can_spell = runs[i].sr_spell;
+    return runs[i].sr_attr;
+}
+
+/*
+ * Forget the lines in syn_line_cache[].  Needed when syntax items or
+ * highlighting changed.
+ */
+    static void
+syn_line_cache_clear()
+{
+    int		i;
+    synline_T	*sl;
+
+    for (i = 0; i < SYN_LINE_CACHE; ++i)
+    {
+	sl = &syn_line_cache[i];
+	clear_syn_state(&sl->sl_start);
+	sl->sl_start.sst_stacksize = 0;
+	clear_syn_state(&sl->sl_end);
+	sl->sl_end.sst_stacksize = 0;
+	ga_clear(&sl->sl_runs);
+	vim_free(sl->sl_line);
+	sl->sl_line = NULL;
+	sl->sl_buf = NULL;
+    }
+    syn_line_rec = NULL;
+    syn_line_play = NULL;
+}
+
+/*
+ * Return TRUE when what the patterns of syn_buf match in a line only depends
+ * on the text of that line.
+ */
+    static int
+syn_patterns_linelocal()
+{
+    int		i;
+    synpat_T	*spp;
+
+    for (i = 0; i < syn_buf->b_syn_patterns.ga_len; ++i)
+    {
+	spp = &(SYN_ITEMS(syn_buf)[i]);
+	if (spp->sp_prog != NULL && (re_multiline(spp->sp_prog)
+					    || re_lookbehind(spp->sp_prog)
+					    || re_stateful(spp->sp_prog)))
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/* Nr of lines parsed at a time while waiting for a character. */
+#define SYN_IDLE_LINES	100
+
+/* Distance between states stored ahead of the window while idle. */
+#define SYN_IDLE_STEP	10
+
+/*
+ * Called while waiting for a character: parse the syntax of the lines in the
+ * two window heights below and the one window height above the current
+ * window, storing a state every SYN_IDLE_STEP lines.  Scrolling with CTRL-F
+ * or CTRL-B then finds a saved state close to the new top line and doesn't
+ * need to synchronize.
+ * Returns TRUE when there is more to do.
+ */
+    int
+syn_idle()
+{
+    static buf_T	*idle_buf = NULL;
+    static int		idle_tick = 0;
+    static linenr_T	idle_top = 0;
+    static linenr_T	idle_bot = 0;
+    static linenr_T	idle_lnum = 0;	/* next line to parse, 0 when done */
+    static int		idle_below = FALSE;	/* parsing below the window */
+    linenr_T		first, last;
+    int			save_did_emsg;
+    int			n;
+
+    if (!syntax_present(curbuf) || curbuf->b_syn_error || curbuf->b_syn_slow
+	    || syn_time_on || curbuf->b_ml.ml_mfp == NULL
+	    || !(curwin->w_valid & VALID_BOTLINE))
+	return FALSE;
+
+    /* Start over when the window shows other lines or text changed. */
+    if (idle_buf != curbuf || idle_tick != curbuf->b_changedtick
+	    || idle_top != curwin->w_topline || idle_bot != curwin->w_botline)
+    {
+	idle_buf = curbuf;
+	idle_tick = curbuf->b_changedtick;
+	idle_top = curwin->w_topline;
+	idle_bot = curwin->w_botline;
+	idle_lnum = idle_bot;
+	idle_below = TRUE;
+    }
+    if (idle_lnum == 0)
+	return FALSE;
+
+    last = idle_bot + curwin->w_height * 2;
+    if (last > curbuf->b_ml.ml_line_count)
+	last = curbuf->b_ml.ml_line_count;
+    first = idle_top - curwin->w_height;
+    if (first < 1)
+	first = 1;
+
+    save_did_emsg = did_emsg;
+    did_emsg = FALSE;
+    for (n = 0; n < SYN_IDLE_LINES; n += SYN_IDLE_STEP)
+    {
+	if (idle_below && idle_lnum > last)
+	{
+	    idle_below = FALSE;
+	    idle_lnum = first;
+	}
+	if (!idle_below && idle_lnum >= idle_top)
+	{
+	    idle_lnum = 0;
+	    break;
+	}
+	syntax_start(curwin, idle_lnum);
+	if (did_emsg || got_int)
+	{
+	    /* The state is wrong when parsing was interrupted. */
+	    invalidate_current_state();
+	    idle_lnum = 0;
+	    break;
+	}
+	idle_lnum += SYN_IDLE_STEP;
+    }
+    if (did_emsg)
+	curbuf->b_syn_error = TRUE;
+    else
+	did_emsg = save_did_emsg;
+    return idle_lnum != 0;
 }
 
 /*
@@ -695,24 +1095,13 @@ syn_sync(wp, start_lnum, last_valid)
     /*
      * Start at least "minlines" back.  Default starting point for parsing is
      * there.
-     * Start further back, to avoid that scrolling backwards will result in
-     * resyncing for every line.  Now it resyncs only one out of N lines,
-     * where N is minlines * 1.5, or minlines * 2 if minlines is small.
      * Watch out for overflow when minlines is MAXLNUM.
      */
     if (syn_buf->b_syn_sync_minlines > start_lnum)
 	start_lnum = 1;
     else
     {
-	if (syn_buf->b_syn_sync_minlines == 1)
-	    lnum = 1;
-	else if (syn_buf->b_syn_sync_minlines < 10)
-	    lnum = syn_buf->b_syn_sync_minlines * 2;
-	else
-	    lnum = syn_buf->b_syn_sync_minlines * 3 / 2;
-	if (syn_buf->b_syn_sync_maxlines != 0
-				       && lnum > syn_buf->b_syn_sync_maxlines)
-	    lnum = syn_buf->b_syn_sync_maxlines;
+	lnum = syn_sync_back();
 	if (lnum >= start_lnum)
 	    start_lnum = 1;
 	else
@@ -928,6 +1317,31 @@ syn_sync(wp, start_lnum, last_valid)
     validate_current_state();
 }
 
+/*
+ * Return the number of lines above the line to synchronize for where
+ * syn_sync() starts parsing.  It starts further back than "minlines", to
+ * avoid that scrolling backwards will result in resyncing for every line.
+ * Now it resyncs only one out of N lines, where N is minlines * 1.5, or
+ * minlines * 2 if minlines is small.
+ * Must not be used when minlines is MAXLNUM.
+ */
+    static linenr_T
+syn_sync_back()
+{
+    linenr_T	n;
+
+    if (syn_buf->b_syn_sync_minlines == 1)
+	n = 1;
+    else if (syn_buf->b_syn_sync_minlines < 10)
+	n = syn_buf->b_syn_sync_minlines * 2;
+    else
+	n = syn_buf->b_syn_sync_minlines * 3 / 2;
+    if (syn_buf->b_syn_sync_maxlines != 0
+				       && n > syn_buf->b_syn_sync_maxlines)
+	n = syn_buf->b_syn_sync_maxlines;
+    return n;
+}
+
 /*
  * Return TRUE if the line-continuation pattern matches in line "lnum".
  */
@@ -941,7 +1355,7 @@ syn_match_linecont(lnum)
     {
 	regmatch.rmm_ic = syn_buf->b_syn_linecont_ic;
 	regmatch.regprog = syn_buf->b_syn_linecont_prog;
-	return syn_regexec(&regmatch, lnum, (colnr_T)0);
+	return syn_regexec(&regmatch, lnum, (colnr_T)0, NULL);
     }
     return FALSE;
 }
@@ -1092,6 +1506,8 @@ syn_stack_free_all(buf)
 	buf->b_sst_array = NULL;
 	buf->b_sst_len = 0;
     }
+    syn_line_cache_clear();
+    buf->b_syn_linelocal = MAYBE;
 #ifdef FEAT_FOLDING
     /* When using "syntax" fold method, must update all folds. */
     FOR_ALL_WINDOWS(wp)
@@ -1345,10 +1761,7 @@ store_current_state(sp)
     synstate_T	*sp;	/* at or before where state is to be saved or
 				   NULL */
 {
-    int		i;
     synstate_T	*p;
-    bufstate_T	*bp;
-    stateitem_T	*cur_si;
 
     if (sp == NULL)
 	sp = syn_stack_find_entry(current_lnum);
@@ -1357,17 +1770,7 @@ store_current_state(sp)
      * If the current state contains a start or end pattern that continues
      * from the previous line, we can't use it.  Don't store it then.
      */
-    for (i = current_state.ga_len - 1; i >= 0; --i)
-    {
-	cur_si = &CUR_STATE(i);
-	if (cur_si->si_h_startpos.lnum >= current_lnum
-		|| cur_si->si_m_endpos.lnum >= current_lnum
-		|| cur_si->si_h_endpos.lnum >= current_lnum
-		|| (cur_si->si_end_idx
-		    && cur_si->si_eoe_pos.lnum >= current_lnum))
-	    break;
-    }
-    if (i >= 0)
+    if (!can_save_current_state(current_lnum))
     {
 	if (sp != NULL)
 	{
@@ -1429,30 +1832,7 @@ store_current_state(sp)
     }
     if (sp != NULL)
     {
-	/* When overwriting an existing state stack, clear it first */
-	clear_syn_state(sp);
-	sp->sst_stacksize = current_state.ga_len;
-	if (current_state.ga_len > SST_FIX_STATES)
-	{
-	    /* Need to clear it, might be something remaining from when the
-	     * length was less than SST_FIX_STATES. */
-	    ga_init2(&sp->sst_union.sst_ga, (int)sizeof(bufstate_T), 1);
-	    if (ga_grow(&sp->sst_union.sst_ga, current_state.ga_len) == FAIL)
-		sp->sst_stacksize = 0;
-	    else
-		sp->sst_union.sst_ga.ga_len = current_state.ga_len;
-	    bp = SYN_STATE_P(&(sp->sst_union.sst_ga));
-	}
-	else
-	    bp = sp->sst_union.sst_stack;
-	for (i = 0; i < sp->sst_stacksize; ++i)
-	{
-	    bp[i].bs_idx = CUR_STATE(i).si_idx;
-	    bp[i].bs_flags = CUR_STATE(i).si_flags;
-	    bp[i].bs_extmatch = ref_extmatch(CUR_STATE(i).si_extmatch);
-	}
-	sp->sst_next_flags = current_next_flags;
-	sp->sst_next_list = current_next_list;
+	save_current_state(sp);
 	sp->sst_tick = display_tick;
 	sp->sst_change_lnum = 0;
     }
@@ -1460,6 +1840,67 @@ store_current_state(sp)
     return sp;
 }
 
+/*
+ * Return TRUE when the current state can be saved as the state at the start
+ * of line "lnum": no start or end pattern continues into that line.
+ */
+    static int
+can_save_current_state(lnum)
+    linenr_T	lnum;
+{
+    int		i;
+    stateitem_T	*cur_si;
+
+    for (i = current_state.ga_len - 1; i >= 0; --i)
+    {
+	cur_si = &CUR_STATE(i);
+	if (cur_si->si_h_startpos.lnum >= lnum
+		|| cur_si->si_m_endpos.lnum >= lnum
+		|| cur_si->si_h_endpos.lnum >= lnum
+		|| (cur_si->si_end_idx
+		    && cur_si->si_eoe_pos.lnum >= lnum))
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Copy the current state stack to "sp", which may already hold a state.
+ */
+    static void
+save_current_state(sp)
+    synstate_T	*sp;
+{
+    int		i;
+    bufstate_T	*bp;
+
+    /* When overwriting an existing state stack, clear it first */
+    clear_syn_state(sp);
+    sp->sst_stacksize = current_state.ga_len;
+    if (current_state.ga_len > SST_FIX_STATES)
+    {
+	/* Need to clear it, might be something remaining from when the
+	 * length was less than SST_FIX_STATES. */
+	ga_init2(&sp->sst_union.sst_ga, (int)sizeof(bufstate_T), 1);
+	if (ga_grow(&sp->sst_union.sst_ga, current_state.ga_len) == FAIL)
+	    sp->sst_stacksize = 0;
+	else
+	    sp->sst_union.sst_ga.ga_len = current_state.ga_len;
+	bp = SYN_STATE_P(&(sp->sst_union.sst_ga));
+    }
+    else
+	bp = sp->sst_union.sst_stack;
+    for (i = 0; i < sp->sst_stacksize; ++i)
+    {
+	bp[i].bs_idx = CUR_STATE(i).si_idx;
+	bp[i].bs_flags = CUR_STATE(i).si_flags;
+	bp[i].bs_extmatch = ref_extmatch(CUR_STATE(i).si_extmatch);
+    }
+    sp->sst_next_flags = current_next_flags;
+    sp->sst_next_list = current_next_list;
+    sp->sst_lnum = current_lnum;
+}
+
 /*
  * Copy a state stack from "from" in b_sst_array[] to current_state;
  */
@@ -1724,6 +2165,7 @@ get_syntax_attr(col, can_spell)
     int		*can_spell;
 {
     int	    attr = 0;
+    int	    spell;
 
     /* check for out of memory situation */
     if (syn_buf->b_sst_array == NULL)
@@ -1740,6 +2182,9 @@ get_syntax_attr(col, can_spell)
 	return 0;
     }
 
+    if (syn_line_play != NULL)
+	return syn_line_replay(col, can_spell);
+
     /* Make sure current_state is valid */
     if (INVALID_STATE(&current_state))
 	validate_current_state();
@@ -1749,7 +2194,17 @@ get_syntax_attr(col, can_spell)
      */
     while (current_col <= col)
     {
-	attr = syn_current_attr(FALSE, TRUE, can_spell);
+	if (syn_line_rec != NULL)
+	{
+	    /* Always get "spell" for the cache entry. */
+	    spell = can_spell == NULL ? TRUE : *can_spell;
+	    attr = syn_current_attr(FALSE, TRUE, &spell);
+	    if (can_spell != NULL)
+		*can_spell = spell;
+	    syn_line_record(attr, spell);
+	}
+	else
+	    attr = syn_current_attr(FALSE, TRUE, can_spell);
 	++current_col;
     }
 
@@ -1788,6 +2243,10 @@ syn_current_attr(syncing, displaying, can_spell)
     reg_extmatch_T *cur_extmatch = NULL;
     char_u	*line;		/* current line.  NOTE: becomes invalid after
 				   looking for a pattern match! */
+    syn_time_T	*st;
+#ifdef FEAT_PROFILE
+    proftime_T	pt;
+#endif
 
     /* variables for zero-width matches that have a "nextgroup" argument */
     int		keep_next_list;
@@ -1883,8 +2342,25 @@ syn_current_attr(syncing, displaying, can_spell)
 #endif
 			       , syn_buf)))
 	      {
+#ifdef FEAT_PROFILE
+		if (syn_time_on)
+		    profile_start(&pt);
+#endif
 		syn_id = check_keyword_id(line, (int)current_col,
 					 &endcol, &flags, &next_list, cur_si);
+		if (syn_time_on)
+		{
+		    st = &syn_buf->b_syn_keyw_time;
+#ifdef FEAT_PROFILE
+		    profile_end(&pt);
+		    profile_add(&st->total, &pt);
+		    if (profile_cmp(&pt, &st->slowest) < 0)
+			st->slowest = pt;
+#endif
+		    ++st->count;
+		    if (syn_id != 0)
+			++st->match;
+		}
 		if (syn_id != 0)
 		{
 		    if (push_current_state(KEYWORD_IDX) == OK)
@@ -1979,7 +2455,7 @@ syn_current_attr(syncing, displaying, can_spell)
 			    regmatch.rmm_ic = spp->sp_ic;
 			    regmatch.regprog = spp->sp_prog;
 			    if (!syn_regexec(&regmatch, current_lnum,
-							     (colnr_T)lc_col))
+					     (colnr_T)lc_col, &spp->sp_time))
 			    {
 				/* no match in this line, try another one */
 				spp->sp_startcol = MAXCOL;
@@ -2811,7 +3287,8 @@ find_endpos(idx, startpos, m_endpos, hl_endpos, flagsp, end_endpos,
 
 	    regmatch.rmm_ic = spp->sp_ic;
 	    regmatch.regprog = spp->sp_prog;
-	    if (syn_regexec(&regmatch, startpos->lnum, lc_col))
+	    if (syn_regexec(&regmatch, startpos->lnum, lc_col,
+							       &spp->sp_time))
 	    {
 		if (best_idx == -1 || regmatch.startpos[0].col
 					      < best_regmatch.startpos[0].col)
@@ -2842,7 +3319,8 @@ find_endpos(idx, startpos, m_endpos, hl_endpos, flagsp, end_endpos,
 		lc_col = 0;
 	    regmatch.rmm_ic = spp_skip->sp_ic;
 	    regmatch.regprog = spp_skip->sp_prog;
-	    if (syn_regexec(&regmatch, startpos->lnum, lc_col)
+	    if (syn_regexec(&regmatch, startpos->lnum, lc_col,
+							  &spp_skip->sp_time)
 		    && regmatch.startpos[0].col
 					     <= best_regmatch.startpos[0].col)
 	    {
@@ -3055,24 +3533,125 @@ syn_getcurline()
 
 /*
  * Call vim_regexec() to find a match with "rmp" in "syn_buf".
+ * When ":syntime" is on and "st" is not NULL add to the statistics in "st".
  * Returns TRUE when there is a match.
  */
     static int
-syn_regexec(rmp, lnum, col)
+syn_regexec(rmp, lnum, col, st)
     regmmatch_T	*rmp;
     linenr_T	lnum;
     colnr_T	col;
+    syn_time_T	*st;
 {
+    int		r;
+    regbudget_T	*budget = syn_budget;
+#ifdef FEAT_PROFILE
+    proftime_T	pt;
+#else
+    regbudget_T	rb;
+    long	steps = 0;
+#endif
+
+    if (syn_time_on && st != NULL)
+    {
+#ifdef FEAT_PROFILE
+	profile_start(&pt);
+#else
+	/* Count the steps, also when matching is not limited. */
+	if (budget == NULL)
+	{
+	    regbudget_init(&rb, 0L);
+	    budget = &rb;
+	}
+	steps = budget->rb_steps;
+#endif
+    }
+
     rmp->rmm_maxcol = syn_buf->b_p_smc;
-    if (vim_regexec_multi(rmp, syn_win, syn_buf, lnum, col) > 0)
+    r = vim_regexec_multi(rmp, syn_win, syn_buf, lnum, col, budget);
+
+    if (syn_time_on && st != NULL)
+    {
+#ifdef FEAT_PROFILE
+	profile_end(&pt);
+	profile_add(&st->total, &pt);
+	if (profile_cmp(&pt, &st->slowest) < 0)
+	    st->slowest = pt;
+#else
+	steps = budget->rb_steps - steps;
+	st->total += steps;
+	if (steps > st->slowest)
+	    st->slowest = steps;
+#endif
+	++st->count;
+	if (r > 0)
+	    ++st->match;
+    }
+
+    if (r > 0)
     {
 	rmp->startpos[0].lnum += lnum;
 	rmp->endpos[0].lnum += lnum;
 	return TRUE;
     }
+    if (syn_budget != NULL && syn_budget->rb_timed_out)
+	/* Too slow: switch off syntax highlighting for this buffer until
+	 * the screen is cleared with CTRL-L. */
+	syn_buf->b_syn_slow = TRUE;
     return FALSE;
 }
 
+/*
+ * Set the budget used for matching syntax patterns while redrawing.
+ * NULL means matching is not limited.
+ */
+    void
+syn_set_budget(rb)
+    regbudget_T	*rb;
+{
+    syn_budget = rb;
+}
+
+/*
+ * Index in b_keywfilter[] for the "len" bytes keyword at "p".
+ */
+#define KEYW_FILTER_IDX(p, len) \
+	(((unsigned)(len) * 131 + (p)[0] * 31 + (p)[(len) - 1]) \
+						      & (KEYW_FILTER_SIZE - 1))
+#define KEYW_FILTER_HAS(buf, i) \
+		       ((buf)->b_keywfilter[(i) >> 3] & (1 << ((i) & 7)))
+
+/*
+ * Fill b_keywfilter[] for the keywords of "buf".  Most words in a file are
+ * not a keyword, the filter rejects them without computing a hash and
+ * comparing strings.  Done when the keywords are used after they changed.
+ */
+    static void
+keyw_filter_build(buf)
+    buf_T	*buf;
+{
+    hashtab_T	*ht;
+    hashitem_T	*hi;
+    int		todo;
+    int		round;
+    unsigned	i;
+
+    vim_memset(buf->b_keywfilter, 0, sizeof(buf->b_keywfilter));
+    for (round = 1; round <= 2; ++round)
+    {
+	ht = round == 1 ? &buf->b_keywtab : &buf->b_keywtab_ic;
+	todo = (int)ht->ht_used;
+	for (hi = ht->ht_array; todo > 0; ++hi)
+	    if (!HASHITEM_EMPTY(hi))
+	    {
+		--todo;
+		i = KEYW_FILTER_IDX(hi->hi_key, STRLEN(hi->hi_key));
+		buf->b_keywfilter[i >> 3] |= 1 << (i & 7);
+	    }
+    }
+    buf->b_keywfilter_ok = TRUE;
+}
+
 /*
  * Check one position in a line for a matching keyword.
  * The caller must check if a keyword can start at startcol.
@@ -3094,25 +3673,22 @@ check_keyword_id(line, startcol, endcolp, flagsp, next_listp, cur_si)
     char_u	keyword[MAXKEYWLEN + 1]; /* assume max. keyword len is 80 */
     hashtab_T	*ht;
     hashitem_T	*hi;
+    unsigned	fidx;
 
     /* Find first character after the keyword.  First character was already
      * checked. */
     kwp = line + startcol;
-    kwlen = 0;
-    do
-    {
-#ifdef FEAT_MBYTE
-	if (has_mbyte)
-	    kwlen += (*mb_ptr2len)(kwp + kwlen);
-	else
-#endif
-	    ++kwlen;
-    }
-    while (vim_iswordc_buf(kwp + kwlen, syn_buf));
+    kwlen = vim_wordlen_buf(kwp, syn_buf);
 
     if (kwlen > MAXKEYWLEN)
 	return 0;
 
+    if (!syn_buf->b_keywfilter_ok)
+	keyw_filter_build(syn_buf);
+    fidx = KEYW_FILTER_IDX(kwp, kwlen);
+    if (syn_buf->b_keywtab_ic.ht_used == 0 && !KEYW_FILTER_HAS(syn_buf, fidx))
+	return 0;
+
     /*
      * Must make a copy of the keyword, so we can add a NUL and make it
      * lowercase.
@@ -3130,7 +3706,12 @@ check_keyword_id(line, startcol, endcolp, flagsp, next_listp, cur_si)
 	if (ht->ht_used == 0)
 	    continue;
 	if (round == 2)	/* ignore case */
+	{
 	    (void)str_foldcase(kwp, kwlen, keyword, MAXKEYWLEN + 1);
+	    fidx = KEYW_FILTER_IDX(keyword, STRLEN(keyword));
+	}
+	if (!KEYW_FILTER_HAS(syn_buf, fidx))
+	    continue;
 
 	/*
 	 * Find keywords that match.  There can be several with different
@@ -3209,7 +3790,11 @@ syn_cmd_spell(eap, syncing)
     else if (STRNICMP(arg, "default", 7) == 0 && next - arg == 7)
 	curbuf->b_syn_spell = SYNSPL_DEFAULT;
     else
+    {
 	EMSG2(_("E390: Illegal argument: %s"), arg);
+	return;
+    }
+    syn_line_cache_clear();	/* cached spell flags may be invalid */
 }
 
 /*
@@ -3222,6 +3807,7 @@ syntax_clear(buf)
     int i;
 
     buf->b_syn_error = FALSE;	    /* clear previous error */
+    buf->b_syn_slow = FALSE;	    /* clear previous timeout */
     buf->b_syn_ic = FALSE;	    /* Use case, by default */
     buf->b_syn_spell = SYNSPL_DEFAULT; /* default spell checking */
     buf->b_syn_containedin = FALSE;
@@ -3229,6 +3815,7 @@ syntax_clear(buf)
     /* free the keywords */
     clear_keywtab(&buf->b_keywtab);
     clear_keywtab(&buf->b_keywtab_ic);
+    buf->b_keywfilter_ok = FALSE;
 
     /* free the syntax patterns */
     for (i = buf->b_syn_patterns.ga_len; --i >= 0; )
@@ -3440,6 +4027,7 @@ syn_clear_one(id, syncing)
     {
 	(void)syn_clear_keyword(id, &curbuf->b_keywtab);
 	(void)syn_clear_keyword(id, &curbuf->b_keywtab_ic);
+	curbuf->b_keywfilter_ok = FALSE;
     }
 
     /* clear the patterns for "id" */
@@ -4165,6 +4753,7 @@ add_keyword(name, id, flags, cont_in_list, next_list)
 	ht = &curbuf->b_keywtab_ic;
     else
 	ht = &curbuf->b_keywtab;
+    curbuf->b_keywfilter_ok = FALSE;
 
     hash = hash_hash(kp->keyword);
     hi = hash_lookup(ht, kp->keyword, hash);
@@ -5960,6 +6549,206 @@ syntax_present(buf)
 	    || curbuf->b_keywtab_ic.ht_used > 0);
 }
 
+/*
+ * ":syntime {on,off,clear,report}"
+ */
+    void
+ex_syntime(eap)
+    exarg_T	*eap;
+{
+    if (STRCMP(eap->arg, "on") == 0)
+	syn_time_on = TRUE;
+    else if (STRCMP(eap->arg, "off") == 0)
+	syn_time_on = FALSE;
+    else if (STRCMP(eap->arg, "clear") == 0)
+	syntime_clear();
+    else if (STRCMP(eap->arg, "report") == 0)
+	syntime_report();
+    else
+	EMSG2(_(e_invarg2), eap->arg);
+}
+
+/*
+ * Clear the ":syntime" statistics of the current buffer.
+ */
+    static void
+syntime_clear()
+{
+    int		idx;
+
+    for (idx = 0; idx < curbuf->b_syn_patterns.ga_len; ++idx)
+	vim_memset(&(SYN_ITEMS(curbuf)[idx].sp_time), 0, sizeof(syn_time_T));
+    vim_memset(&curbuf->b_syn_keyw_time, 0, sizeof(syn_time_T));
+}
+
+/*
+ * An item in the ":syntime report" list.
+ */
+typedef struct
+{
+    syn_time_T	*st;		/* statistics of the item */
+    int		id;		/* syntax group ID, zero for keywords */
+    char_u	*pattern;	/* pattern, NULL for keywords */
+} syntime_item_T;
+
+/*
+ * Compare function for qsort(): most costly item first.
+ */
+    static int
+#ifdef __BORLANDC__
+_RTLENTRYF
+#endif
+syntime_compare(v1, v2)
+    const void	*v1;
+    const void	*v2;
+{
+    const syn_time_T	*st1 = ((const syntime_item_T *)v1)->st;
+    const syn_time_T	*st2 = ((const syntime_item_T *)v2)->st;
+
+#ifdef FEAT_PROFILE
+    return profile_cmp((proftime_T *)&st1->total, (proftime_T *)&st2->total);
+#else
+    return st1->total > st2->total ? -1 : st1->total < st2->total ? 1 : 0;
+#endif
+}
+
+#ifdef FEAT_PROFILE
+# define SYNTIME_MSG(cost) profile_msg(&(cost))
+#else
+# define SYNTIME_MSG(cost) syntime_steps_msg(cost)
+
+/*
+ * Return a string for "steps", in the same width as profile_msg().
+ * Uses a static buffer!
+ */
+    static char *
+syntime_steps_msg(steps)
+    long	steps;
+{
+    static char buf[30];
+
+    sprintf(buf, "%10ld", steps);
+    return buf;
+}
+#endif
+
+/*
+ * List the patterns of the current buffer that were tried since ":syntime
+ * on", the most costly one first.
+ */
+    static void
+syntime_report()
+{
+    int			idx;
+    synpat_T		*spp;
+    garray_T		ga;
+    syntime_item_T	*p;
+    syn_time_T		total;
+    int			len;
+#ifdef FEAT_PROFILE
+    proftime_T		tm;
+#endif
+
+    if (!syntax_present(curbuf))
+    {
+	MSG(_("No Syntax items defined for this buffer"));
+	return;
+    }
+
+    ga_init2(&ga, (int)sizeof(syntime_item_T), 50);
+    vim_memset(&total, 0, sizeof(total));
+    for (idx = 0; idx <= curbuf->b_syn_patterns.ga_len; ++idx)
+    {
+	/* The keywords are listed as one item, after the patterns. */
+	if (idx == curbuf->b_syn_patterns.ga_len)
+	    spp = NULL;
+	else
+	    spp = &(SYN_ITEMS(curbuf)[idx]);
+	if (ga_grow(&ga, 1) == FAIL)
+	    break;
+	p = (syntime_item_T *)ga.ga_data + ga.ga_len;
+	p->st = spp == NULL ? &curbuf->b_syn_keyw_time : &spp->sp_time;
+	if (p->st->count == 0)
+	    continue;
+	p->id = spp == NULL ? 0 : spp->sp_syn.id;
+	p->pattern = spp == NULL ? NULL : spp->sp_pattern;
+	++ga.ga_len;
+
+#ifdef FEAT_PROFILE
+	profile_add(&total.total, &p->st->total);
+#else
+	total.total += p->st->total;
+#endif
+	total.count += p->st->count;
+	total.match += p->st->match;
+    }
+
+    /* Sort on total cost. */
+    qsort(ga.ga_data, (size_t)ga.ga_len, sizeof(syntime_item_T),
+							     syntime_compare);
+
+#ifdef FEAT_PROFILE
+    MSG_PUTS_TITLE(_("  TOTAL      COUNT  MATCH   SLOWEST     AVERAGE   NAME               PATTERN"));
+#else
+    MSG_PUTS_TITLE(_("     STEPS   COUNT  MATCH       MOST     AVERAGE  NAME               PATTERN"));
+#endif
+    MSG_PUTS("\n");
+    for (idx = 0; idx < ga.ga_len && !got_int; ++idx)
+    {
+	p = ((syntime_item_T *)ga.ga_data) + idx;
+
+	MSG_PUTS(SYNTIME_MSG(p->st->total));
+	MSG_PUTS(" ");	/* make sure there is always a separating space */
+	msg_advance(13);
+	msg_outnum(p->st->count);
+	MSG_PUTS(" ");
+	msg_advance(20);
+	msg_outnum(p->st->match);
+	MSG_PUTS(" ");
+	msg_advance(26);
+	MSG_PUTS(SYNTIME_MSG(p->st->slowest));
+	MSG_PUTS(" ");
+	msg_advance(38);
+#ifdef FEAT_PROFILE
+	profile_divide(&p->st->total, p->st->count, &tm);
+	MSG_PUTS(profile_msg(&tm));
+#else
+	MSG_PUTS(syntime_steps_msg(p->st->total / p->st->count));
+#endif
+	MSG_PUTS(" ");
+	msg_advance(50);
+	if (p->id == 0)
+	    MSG_PUTS(_("(keywords)"));
+	else
+	    msg_outtrans(HL_TABLE()[p->id - 1].sg_name);
+	MSG_PUTS(" ");
+
+	msg_advance(69);
+	if (p->pattern != NULL)
+	{
+	    len = Columns - 1 - msg_col;
+	    if (len > (int)STRLEN(p->pattern))
+		len = (int)STRLEN(p->pattern);
+	    if (len > 0)
+		msg_outtrans_len(p->pattern, len);
+	}
+	MSG_PUTS("\n");
+    }
+    ga_clear(&ga);
+    if (!got_int)
+    {
+	MSG_PUTS("\n");
+	MSG_PUTS(SYNTIME_MSG(total.total));
+	MSG_PUTS(" ");
+	msg_advance(13);
+	msg_outnum(total.count);
+	MSG_PUTS(" ");
+	msg_advance(20);
+	msg_outnum(total.match);
+	MSG_PUTS("\n");
+    }
+}
+
 #if defined(FEAT_CMDL_COMPL) || defined(PROTO)
 
 static enum
@@ -6050,6 +6839,50 @@ syn_get_id(wp, lnum, col, trans, spellp)
     return (trans ? current_trans_id : current_id);
 }
 
+/*
+ * Get the syntax ID for every byte of line "lnum" in window "wp" in one pass
+ * over the line.  The IDs are appended to "gap", which must be a growarray
+ * of ints, one for each byte of the line.  Bytes of a multi-byte character
+ * get the ID of its first byte, like when the line is displayed.
+ * This is much cheaper than calling syn_get_id() for each column.
+ * Returns FAIL when out of memory.
+ */
+    int
+syn_get_line_ids(wp, lnum, trans, gap)
+    win_T	*wp;
+    linenr_T	lnum;
+    int		trans;	    /* remove transparancy */
+    garray_T	*gap;
+{
+    colnr_T	len;
+    colnr_T	col;
+    int		id;
+    int		l;
+    int		i;
+
+    len = (colnr_T)STRLEN(ml_get_buf(wp->w_buffer, lnum, FALSE));
+    if (ga_grow(gap, len) == FAIL)
+	return FAIL;
+
+    syntax_start(wp, lnum);
+    for (col = 0; col < len; col += l)
+    {
+	(void)get_syntax_attr(col, NULL);
+	id = trans ? current_trans_id : current_id;
+	l = 1;
+#ifdef FEAT_MBYTE
+	/* Get the line again, a multi-line regexp may invalidate it. */
+	if (has_mbyte)
+	    l = (*mb_ptr2len)(ml_get_buf(wp->w_buffer, lnum, FALSE) + col);
+	if (l < 1 || col + l > len)
+	    l = 1;
+#endif
+	for (i = 0; i < l; ++i)
+	    ((int *)gap->ga_data)[gap->ga_len++] = id;
+    }
+    return OK;
+}
+
 #if defined(FEAT_FOLDING) || defined(PROTO)
 /*
  * Function called to get folding level for line "lnum" in window "wp".
@@ -7738,34 +8571,94 @@ static garray_T	gui_attr_table = {0, 0, 0, 0, NULL};
 #define GUI_ATTR_ENTRY(idx) ((attrentry_T *)gui_attr_table.ga_data)[idx]
 #endif
 
+#if defined(FEAT_SYN_HL) || defined(FEAT_SPELL)
 /*
- * Return the attr number for a set of colors and font.
- * Add a new entry to the term_attr_table, cterm_attr_table or gui_attr_table
- * if the combination is new.
- * Return 0 for error (no more room).
+ * Results of hl_combine_attr(), cleared together with the tables.
  */
-    static int
-get_attr_entry(table, aep)
+typedef struct
+{
+    garray_T	*ac_table;	/* table of ac_attr, NULL when not used */
+    int		ac_char_attr;
+    int		ac_prim_attr;
+    int		ac_attr;	/* the combined attributes */
+} attrcombine_T;
+
+# define ATTR_COMBINE_SIZE 64
+
+static attrcombine_T attr_combine[ATTR_COMBINE_SIZE];
+#endif
+
+/* Index for each table, see attrhash_T. */
+static attrhash_T term_attr_hash = {NULL, 0};
+static attrhash_T cterm_attr_hash = {NULL, 0};
+#ifdef FEAT_GUI
+static attrhash_T gui_attr_hash = {NULL, 0};
+#endif
+
+/*
+ * Return the index for attribute table "table".
+ */
+    static attrhash_T *
+attr_table_hash(table)
     garray_T	*table;
-    attrentry_T	*aep;
 {
-    int		i;
-    attrentry_T	*taep;
-    static int	recursive = FALSE;
+#ifdef FEAT_GUI
+    if (table == &gui_attr_table)
+	return &gui_attr_hash;
+#endif
+    if (table == &term_attr_table)
+	return &term_attr_hash;
+    return &cterm_attr_hash;
+}
 
-    /*
-     * Init the table, in case it wasn't done yet.
-     */
-    table->ga_itemsize = sizeof(attrentry_T);
-    table->ga_growsize = 7;
+/*
+ * Compute the hash of the specifications in "aep" for table "table".
+ */
+    static unsigned
+attr_entry_hash(table, aep)
+    garray_T	*table;
+    attrentry_T	*aep;
+{
+    unsigned	hash = aep->ae_attr;
+    char_u	*p;
 
-    /*
-     * Try to find an entry with the same specifications.
-     */
-    for (i = 0; i < table->ga_len; ++i)
+#ifdef FEAT_GUI
+    if (table == &gui_attr_table)
+    {
+	hash = hash * 31 + (unsigned)aep->ae_u.gui.fg_color;
+	hash = hash * 31 + (unsigned)aep->ae_u.gui.bg_color;
+	hash = hash * 31 + (unsigned)aep->ae_u.gui.sp_color;
+	hash = hash * 31 + (unsigned)(long_u)aep->ae_u.gui.font;
+	return hash;
+    }
+#endif
+    if (table == &term_attr_table)
     {
-	taep = &(((attrentry_T *)table->ga_data)[i]);
-	if (	   aep->ae_attr == taep->ae_attr
+	if (aep->ae_u.term.start != NULL)
+	    for (p = aep->ae_u.term.start; *p != NUL; ++p)
+		hash = hash * 31 + *p;
+	hash = hash * 31 + 1;
+	if (aep->ae_u.term.stop != NULL)
+	    for (p = aep->ae_u.term.stop; *p != NUL; ++p)
+		hash = hash * 31 + *p;
+	return hash;
+    }
+    hash = hash * 31 + aep->ae_u.cterm.fg_color;
+    hash = hash * 31 + aep->ae_u.cterm.bg_color;
+    return hash;
+}
+
+/*
+ * Return TRUE when "aep" and "taep" have the same specifications for table
+ * "table".
+ */
+    static int
+attr_entry_equal(table, aep, taep)
+    garray_T	*table;
+    attrentry_T	*aep;
+    attrentry_T	*taep;
+{
+    return (       aep->ae_attr == taep->ae_attr
 		&& (
 #ifdef FEAT_GUI
 		       (table == &gui_attr_table
@@ -7797,10 +8690,98 @@ get_attr_entry(table, aep)
 						  == taep->ae_u.cterm.fg_color
 			    && aep->ae_u.cterm.bg_color
 						 == taep->ae_u.cterm.bg_color)
-		     ))
+		     ));
+}
+
+/*
+ * Return the slot in "ahp" for an entry of "table" equal to "aep", or the
+ * unused slot where it can be added.
+ */
+    static int
+attr_hash_slot(table, ahp, aep)
+    garray_T	*table;
+    attrhash_T	*ahp;
+    attrentry_T	*aep;
+{
+    int		mask = ahp->ah_size - 1;
+    int		slot;
+    int		idx;
+
+    slot = attr_entry_hash(table, aep) & mask;
+    while ((idx = ahp->ah_idx[slot]) != 0
+	    && !attr_entry_equal(table, aep,
+				   &(((attrentry_T *)table->ga_data)[idx - 1])))
+	slot = (slot + 1) & mask;
+    return slot;
+}
+
+/*
+ * Make sure index "ahp" has room for one more entry of "table".
+ * Return FAIL when out of memory.
+ */
+    static int
+attr_hash_room(table, ahp)
+    garray_T	*table;
+    attrhash_T	*ahp;
+{
+    int		size;
+    int		*old_idx;
+    int		old_size;
+    int		i;
 
-	return i + ATTR_OFF;
+    if ((table->ga_len + 1) * 2 <= ahp->ah_size)
+	return OK;
+    for (size = 64; size < (table->ga_len + 1) * 2; size *= 2)
+	;
+    old_idx = ahp->ah_idx;
+    old_size = ahp->ah_size;
+    ahp->ah_idx = (int *)lalloc_clear((long_u)(size * sizeof(int)), TRUE);
+    if (ahp->ah_idx == NULL)
+    {
+	ahp->ah_idx = old_idx;
+	return FAIL;
     }
+    ahp->ah_size = size;
+    for (i = 0; i < old_size; ++i)
+	if (old_idx[i] != 0)
+	    ahp->ah_idx[attr_hash_slot(table, ahp,
+		    &(((attrentry_T *)table->ga_data)[old_idx[i] - 1]))]
+								  = old_idx[i];
+    vim_free(old_idx);
+    return OK;
+}
+
+/*
+ * Return the attr number for a set of colors and font.
+ * Add a new entry to the term_attr_table, cterm_attr_table or gui_attr_table
+ * if the combination is new.
+ * Return 0 for error (no more room).
+ */
+    static int
+get_attr_entry(table, aep)
+    garray_T	*table;
+    attrentry_T	*aep;
+{
+    int		i;
+    attrentry_T	*taep;
+    attrhash_T	*ahp = attr_table_hash(table);
+    int		slot;
+    static int	recursive = FALSE;
+
+    /*
+     * Init the table, in case it wasn't done yet.
+     */
+    table->ga_itemsize = sizeof(attrentry_T);
+    table->ga_growsize = 7;
+
+    /*
+     * Try to find an entry with the same specifications.
+     */
+    if (attr_hash_room(table, ahp) == FAIL)
+	return 0;
+    slot = attr_hash_slot(table, ahp, aep);
+    if (ahp->ah_idx[slot] != 0)
+	return ahp->ah_idx[slot] - 1 + ATTR_OFF;
 
     if (table->ga_len + ATTR_OFF > MAX_TYPENR)
     {
@@ -7824,6 +8805,13 @@ get_attr_entry(table, aep)
 	    set_hl_attr(i);
 
 	recursive = FALSE;
+
+	/* The index was cleared and filled again. */
+	if (attr_hash_room(table, ahp) == FAIL)
+	    return 0;
+	slot = attr_hash_slot(table, ahp, aep);
+	if (ahp->ah_idx[slot] != 0)
+	    return ahp->ah_idx[slot] - 1 + ATTR_OFF;
     }
 
     /*
@@ -7864,6 +8852,7 @@ get_attr_entry(table, aep)
 	taep->ae_u.cterm.bg_color = aep->ae_u.cterm.bg_color;
     }
     ++table->ga_len;
+    ahp->ah_idx[slot] = table->ga_len;
     return (table->ga_len - 1 + ATTR_OFF);
 }
 
@@ -7878,6 +8867,9 @@ clear_hl_tables()
 
 #ifdef FEAT_GUI
     ga_clear(&gui_attr_table);
+    vim_free(gui_attr_hash.ah_idx);
+    gui_attr_hash.ah_idx = NULL;
+    gui_attr_hash.ah_size = 0;
 #endif
     for (i = 0; i < term_attr_table.ga_len; ++i)
     {
@@ -7887,6 +8879,18 @@ clear_hl_tables()
     }
     ga_clear(&term_attr_table);
     ga_clear(&cterm_attr_table);
+    vim_free(term_attr_hash.ah_idx);
+    term_attr_hash.ah_idx = NULL;
+    term_attr_hash.ah_size = 0;
+    vim_free(cterm_attr_hash.ah_idx);
+    cterm_attr_hash.ah_idx = NULL;
+    cterm_attr_hash.ah_size = 0;
+#if defined(FEAT_SYN_HL) || defined(FEAT_SPELL)
+    vim_memset(attr_combine, 0, sizeof(attr_combine));
+#endif
+#ifdef FEAT_SYN_HL
+    syn_line_cache_clear();	/* cached attributes are invalid */
+#endif
 }
 
 #if defined(FEAT_SYN_HL) || defined(FEAT_SPELL) || defined(PROTO)
@@ -7895,8 +8899,8 @@ clear_hl_tables()
  * (e.g., for syntax highlighting).
  * "prim_attr" overrules "char_attr".
  * This creates a new group when required.
- * Since we expect there to be few spelling mistakes we don't cache the
- * result.
+ * The result is remembered in attr_combine[], drawing a line often combines
+ * the same attributes for many characters.
  * Return the resulting attributes.
  */
     int
@@ -7904,14 +8908,54 @@ hl_combine_attr(char_attr, prim_attr)
     int	    char_attr;
     int	    prim_attr;
 {
-    attrentry_T *char_aep = NULL;
-    attrentry_T *spell_aep;
-    attrentry_T new_en;
+    garray_T	*table;
+    attrcombine_T *acp;
+    int		attr;
 
     if (char_attr == 0)
 	return prim_attr;
     if (char_attr <= HL_ALL && prim_attr <= HL_ALL)
 	return char_attr | prim_attr;
+
+#ifdef FEAT_GUI
+    if (gui.in_use)
+	table = &gui_attr_table;
+    else
+#endif
+    if (t_colors > 1)
+	table = &cterm_attr_table;
+    else
+	table = &term_attr_table;
+    acp = &attr_combine[(unsigned)(char_attr * 31 + prim_attr)
+							 % ATTR_COMBINE_SIZE];
+    if (acp->ac_table != table || acp->ac_char_attr != char_attr
+					     || acp->ac_prim_attr != prim_attr)
+    {
+	attr = hl_new_combined_attr(char_attr, prim_attr);
+	if (attr == 0)
+	    return 0;
+	/* get_attr_entry() may have cleared attr_combine[] */
+	acp->ac_table = table;
+	acp->ac_char_attr = char_attr;
+	acp->ac_prim_attr = prim_attr;
+	acp->ac_attr = attr;
+    }
+    return acp->ac_attr;
+}
+
+/*
+ * Add the attributes for "char_attr" combined with "prim_attr" to the
+ * current table, used by hl_combine_attr().
+ */
+    static int
+hl_new_combined_attr(char_attr, prim_attr)
+    int	    char_attr;
+    int	    prim_attr;
+{
+    attrentry_T *char_aep = NULL;
+    attrentry_T *spell_aep;
+    attrentry_T new_en;
+
 #ifdef FEAT_GUI
     if (gui.in_use)
     {
@@ -8768,6 +9812,9 @@ highlight_changed()
     static int	hl_flags[HLF_COUNT] = HL_FLAGS;
 
     need_highlight_changed = FALSE;
+#ifdef FEAT_SYN_HL
+    syn_line_cache_clear();	/* cached attributes may be invalid */
+#endif
 
     /*
      * Clear all attributes.
@@ -2565,6 +2565,8 @@ termcapinit(name)
 
 /*
  * the number of calls to ui_write is reduced by using the buffer "out_buf"
+ * While the screen is being updated the buffer grows, up to OUT_SIZE_MAX, so
+ * that a screen update is written in one go.
  */
 #ifdef DOS16
 # define OUT_SIZE	255		/* only have 640K total... */
@@ -2573,12 +2575,45 @@ termcapinit(name)
 #  define OUT_SIZE	1023		/* Save precious 1K near data */
 # else
 #  define OUT_SIZE	2047
+#  define OUT_SIZE_MAX	65535
 # endif
 #endif
 	    /* Add one to allow mch_write() in os_win32.c to append a NUL */
-static char_u		out_buf[OUT_SIZE + 1];
+static char_u		out_buf_init[OUT_SIZE + 1];
+static char_u		*out_buf = out_buf_init;
+static int		out_size = OUT_SIZE;	/* size of out_buf minus one */
 static int		out_pos = 0;	/* number of chars in out_buf */
 
+static void out_buf_full __ARGS((void));
+
+/*
+ * Called when "out_buf" is full.  While updating the screen make it bigger,
+ * otherwise flush it.
+ */
+    static void
+out_buf_full()
+{
+#ifdef OUT_SIZE_MAX
+    char_u	*p;
+
+    if (updating_screen && out_size < OUT_SIZE_MAX)
+    {
+	/* Don't give an error message, we are in the middle of output. */
+	p = lalloc((long_u)(out_size * 2 + 2), FALSE);
+	if (p != NULL)
+	{
+	    mch_memmove(p, out_buf, (size_t)out_pos);
+	    if (out_buf != out_buf_init)
+		vim_free(out_buf);
+	    out_buf = p;
+	    out_size = out_size * 2 + 1;
+	    return;
+	}
+    }
+#endif
+    out_flush();
+}
+
 /*
  * out_flush(): flush the output buffer
  */
@@ -2604,8 +2639,8 @@ out_flush()
     void
 out_flush_check()
 {
-    if (enc_dbcs != 0 && out_pos >= OUT_SIZE - MB_MAXBYTES)
-	out_flush();
+    if (enc_dbcs != 0 && out_pos >= out_size - MB_MAXBYTES)
+	out_buf_full();
 }
 #endif
 
@@ -2638,8 +2673,10 @@ out_char(c)
     out_buf[out_pos++] = c;
 
     /* For testing we flush each time. */
-    if (out_pos >= OUT_SIZE || p_wd)
+    if (p_wd)
 	out_flush();
+    else if (out_pos >= out_size)
+	out_buf_full();
 }
 
 static void out_char_nf __ARGS((unsigned));
@@ -2658,8 +2695,8 @@ out_char_nf(c)
 
     out_buf[out_pos++] = c;
 
-    if (out_pos >= OUT_SIZE)
-	out_flush();
+    if (out_pos >= out_size)
+	out_buf_full();
 }
 
 /*
@@ -2675,8 +2712,8 @@ out_char_nf(c)
 out_str_nf(s)
     char_u *s;
 {
-    if (out_pos > OUT_SIZE - 20)  /* avoid terminal strings being split up */
-	out_flush();
+    if (out_pos > out_size - 20)  /* avoid terminal strings being split up */
+	out_buf_full();
     while (*s)
 	out_char_nf(*s++);
 
@@ -2706,8 +2743,8 @@ out_str(s)
 	}
 #endif
 	/* avoid terminal strings being split up */
-	if (out_pos > OUT_SIZE - 20)
-	    out_flush();
+	if (out_pos > out_size - 20)
+	    out_buf_full();
 #ifdef HAVE_TGETENT
 	tputs((char *)s, 1, TPUTSFUNCAST out_char_nf);
 #else
@@ -463,7 +463,8 @@ u_savecommon(top, bot, newbot)
 	u_getbot();
     }
 
-#if !defined(UNIX) && !defined(DJGPP) && !defined(WIN32) && !defined(__EMX__)
+#if !defined(UNIX) && !defined(DJGPP) && !defined(WIN32) && !defined(__EMX__) \
+	&& !defined(PLAN9)
 	/*
 	 * With Amiga and MSDOS 16 bit we can't handle big undo's, because
 	 * then u_alloc_line would have to allocate a block larger than 32K
@@ -773,6 +773,7 @@ extern char *(*dyn_libintl_textdomain)(const char *domainname);
 # endif
 # define SST_FIX_STATES	 7	/* size of sst_stack[]. */
 # define SST_DIST	 16	/* normal distance between entries */
+# define KEYW_FILTER_SIZE 1024	/* nr of bits in b_keywfilter[] */
 #endif
 
 /* Values for 'options' argument in do_search() and searchit() */
@@ -1555,6 +1556,17 @@ int vim_memcmp __ARGS((void *, void *, size_t));
  * buffer-local options is used there. */
 #include "option.h"	    /* options and default values */
 
+/* Define proftime_T before including structs.h, regexp.h uses it. */
+#if (defined(FEAT_PROFILE) || defined(FEAT_RELTIME)) && !defined(PROTO)
+# ifdef WIN3264
+typedef LARGE_INTEGER proftime_T;
+# else
+typedef struct timeval proftime_T;
+# endif
+#else
+typedef int proftime_T;	    /* dummy for function prototypes */
+#endif
+
 /* Note that gui.h is included by structs.h */
 
 #include "structs.h"	    /* file that defines many structures */
@@ -1762,16 +1774,6 @@ typedef int VimClipboard;	/* This is required for the prototypes. */
 # define stat(a,b) (access(a,0) ? -1 : stat(a,b))
 #endif
 
-#if (defined(FEAT_PROFILE) || defined(FEAT_RELTIME)) && !defined(PROTO)
-# ifdef WIN3264
-typedef LARGE_INTEGER proftime_T;
-# else
-typedef struct timeval proftime_T;
-# endif
-#else
-typedef int proftime_T;	    /* dummy for function prototypes */
-#endif
-
 #include "ex_cmds.h"	    /* Ex command defines */
 #include "proto.h"	    /* function prototypes */
 
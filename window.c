@@ -4180,6 +4180,7 @@ win_free(wp, tp)
     if (prevwin == wp)
 	prevwin = NULL;
     win_free_lsize(wp);
+    vim_free(wp->w_plines_cache);
 
     for (i = 0; i < wp->w_tagstacklen; ++i)
 	vim_free(wp->w_tagstack[i].tagname);